@@ -0,0 +1,35 @@
+\connect fzon
+
+-- Состояния записей для общего outbox-консьюмера (services/libs/outbox):
+-- PENDING -> DELIVERY -> DONE, после max-attempts неудачных попыток - DEAD
+ALTER TABLE bankserviceschema.outbox
+    ADD COLUMN IF NOT EXISTS status VARCHAR(20) NOT NULL DEFAULT 'PENDING',
+    ADD COLUMN IF NOT EXISTS attempts INTEGER NOT NULL DEFAULT 0,
+    ADD COLUMN IF NOT EXISTS next_attempt_at TIMESTAMPTZ NOT NULL DEFAULT now(),
+    ADD COLUMN IF NOT EXISTS last_error TEXT,
+    ADD COLUMN IF NOT EXISTS delivery JSONB;
+
+UPDATE bankserviceschema.outbox SET status = 'DONE' WHERE processed;
+
+DROP INDEX IF EXISTS bankserviceschema.outbox_pending_idx;
+DROP INDEX IF EXISTS bankserviceschema.outbox_processed_created_at_idx;
+ALTER TABLE bankserviceschema.outbox DROP COLUMN processed;
+
+-- Выборка консьюмера и метрики backlog
+CREATE INDEX IF NOT EXISTS outbox_pending_idx
+    ON bankserviceschema.outbox (id)
+    WHERE status IN ('PENDING', 'DELIVERY');
+
+-- Проверка, что более ранняя запись пользователя не ждет повтора
+CREATE INDEX IF NOT EXISTS outbox_pending_user_idx
+    ON bankserviceschema.outbox (user_id, id)
+    WHERE status = 'PENDING';
+
+CREATE INDEX IF NOT EXISTS outbox_dead_idx
+    ON bankserviceschema.outbox (id)
+    WHERE status = 'DEAD';
+
+-- Для архивации обработанных записей по возрасту
+CREATE INDEX IF NOT EXISTS outbox_done_created_at_idx
+    ON bankserviceschema.outbox (created_at)
+    WHERE status = 'DONE';
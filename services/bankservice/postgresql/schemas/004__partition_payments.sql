@@ -0,0 +1,51 @@
+\connect fzon
+
+-- payments секционируется по месяцам created_at (RANGE).
+-- Секция за месяц YYYYMM называется payments_pYYYYMM; будущие секции создает
+-- и старые отсоединяет в bankservicearchive компонент partition-maintenance (services/libs/partitioning)
+
+CREATE SCHEMA IF NOT EXISTS bankservicearchive;
+
+CREATE TABLE bankserviceschema.payments_partitioned (
+    id INTEGER NOT NULL,
+    order_id INTEGER NOT NULL,
+    user_id INTEGER NOT NULL,
+    amount NUMERIC(10,2) NOT NULL,
+    status VARCHAR(20) NOT NULL DEFAULT 'PENDING',
+    created_at TIMESTAMP NOT NULL DEFAULT now(),
+    PRIMARY KEY (id, created_at)
+) PARTITION BY RANGE (created_at);
+
+-- Секции от месяца самого старого платежа до трех месяцев вперед
+DO $$
+DECLARE
+    v_month DATE := date_trunc('month', COALESCE((SELECT MIN(created_at) FROM bankserviceschema.payments), now()))::date;
+    v_last DATE := (date_trunc('month', now()) + interval '3 months')::date;
+BEGIN
+    WHILE v_month <= v_last LOOP
+        EXECUTE format(
+            'CREATE TABLE bankserviceschema.%I PARTITION OF bankserviceschema.payments_partitioned '
+            'FOR VALUES FROM (%L) TO (%L)',
+            'payments_p' || to_char(v_month, 'YYYYMM'), v_month, (v_month + interval '1 month')::date
+        );
+        v_month := (v_month + interval '1 month')::date;
+    END LOOP;
+END $$;
+
+INSERT INTO bankserviceschema.payments_partitioned (id, order_id, user_id, amount, status, created_at)
+SELECT id, order_id, user_id, amount, status, COALESCE(created_at, now()) FROM bankserviceschema.payments;
+
+ALTER SEQUENCE bankserviceschema.payments_id_seq OWNED BY NONE;
+
+DROP TABLE bankserviceschema.payments;
+
+ALTER TABLE bankserviceschema.payments_partitioned RENAME TO payments;
+ALTER INDEX bankserviceschema.payments_partitioned_pkey RENAME TO payments_pkey;
+
+ALTER TABLE bankserviceschema.payments
+    ALTER COLUMN id SET DEFAULT nextval('bankserviceschema.payments_id_seq');
+ALTER SEQUENCE bankserviceschema.payments_id_seq OWNED BY bankserviceschema.payments.id;
+
+-- Платежи по заказу; created_at в ключе позволяет отсекать секции по времени
+CREATE INDEX IF NOT EXISTS payments_order_id_created_at_idx
+    ON bankserviceschema.payments (order_id, created_at);
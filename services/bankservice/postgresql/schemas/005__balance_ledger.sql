@@ -0,0 +1,47 @@
+\connect fzon
+
+-- Баланс пользователя больше не хранится в users.balance: пополнения и списания
+-- дописываются в ledger, баланс = последний снимок + сумма записей после него.
+-- Записи одного пользователя пишутся под pg_advisory_xact_lock(hashtext('bankservice_ledger'), user_id),
+-- поэтому коммитятся в порядке id и снимок по MAX(id) пользователя не пропускает записей
+
+CREATE TABLE IF NOT EXISTS bankserviceschema.ledger (
+    id BIGSERIAL PRIMARY KEY,
+    user_id INTEGER NOT NULL,
+    -- Пополнение положительное, списание отрицательное
+    amount NUMERIC(12,2) NOT NULL,
+    -- OPENING - перенос баланса из users, TOP_UP, PAYMENT
+    kind VARCHAR(20) NOT NULL,
+    order_id INTEGER,
+    created_at TIMESTAMP NOT NULL DEFAULT now()
+);
+
+-- Сумма записей пользователя после снимка
+CREATE INDEX IF NOT EXISTS ledger_user_id_idx
+    ON bankserviceschema.ledger (user_id, id);
+
+-- Пользователи с новыми записями для очередного снимка
+CREATE INDEX IF NOT EXISTS ledger_created_at_idx
+    ON bankserviceschema.ledger (created_at);
+
+-- Баланс пользователя на записи ledger_id включительно; обновляется только периодическим снимком
+CREATE TABLE IF NOT EXISTS bankserviceschema.balance_snapshots (
+    user_id INTEGER PRIMARY KEY,
+    balance NUMERIC(12,2) NOT NULL,
+    ledger_id BIGINT NOT NULL,
+    taken_at TIMESTAMP NOT NULL DEFAULT now()
+);
+
+-- Перенос текущих балансов
+INSERT INTO bankserviceschema.ledger (user_id, amount, kind)
+SELECT user_id, balance, 'OPENING'
+FROM bankserviceschema.users
+WHERE balance <> 0;
+
+INSERT INTO bankserviceschema.balance_snapshots (user_id, balance, ledger_id)
+SELECT user_id, SUM(amount), MAX(id)
+FROM bankserviceschema.ledger
+GROUP BY user_id
+ON CONFLICT (user_id) DO NOTHING;
+
+ALTER TABLE bankserviceschema.users DROP COLUMN IF EXISTS balance;
@@ -0,0 +1,17 @@
+\connect fzon
+
+-- Ключи идемпотентности запросов на оплату: повтор запроса с тем же ключом
+-- не создает вторую запись outbox. Ключ - заголовок Idempotency-Key или order:<order_id>
+CREATE TABLE IF NOT EXISTS bankserviceschema.payment_requests (
+    idempotency_key VARCHAR(128) PRIMARY KEY,
+    order_id INTEGER NOT NULL,
+    created_at TIMESTAMP NOT NULL DEFAULT now()
+);
+
+-- Уже принятые запросы
+INSERT INTO bankserviceschema.payment_requests (idempotency_key, order_id, created_at)
+SELECT 'order:' || (payload->>'order_id'), (payload->>'order_id')::int, COALESCE(MIN(created_at), now())
+FROM bankserviceschema.outbox
+WHERE payload ? 'order_id'
+GROUP BY payload->>'order_id'
+ON CONFLICT (idempotency_key) DO NOTHING;
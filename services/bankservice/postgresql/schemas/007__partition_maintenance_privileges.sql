@@ -0,0 +1,31 @@
+\connect fzon
+
+-- partition-maintenance работает под ролью сервиса (BANK_DB_USER из .env, здесь bankservice),
+-- а payments пересоздала миграция 004 под суперпользователем.
+-- Создавать, отсоединять и переносить секции может только владелец таблицы,
+-- поэтому таблица со всеми секциями передается роли сервиса, а на обе схемы выдается CREATE
+
+GRANT USAGE, CREATE ON SCHEMA bankserviceschema TO bankservice;
+GRANT USAGE, CREATE ON SCHEMA bankservicearchive TO bankservice;
+
+-- Секция по умолчанию: строка, для месяца которой секция еще не создана, не ломает вставку.
+-- partition-maintenance переносит такие строки в секцию месяца, когда создает ее
+CREATE TABLE IF NOT EXISTS bankserviceschema.payments_default
+    PARTITION OF bankserviceschema.payments DEFAULT;
+
+-- ALTER TABLE ... OWNER не переходит на секции, их меняем по одной.
+-- Последовательность payments_id_seq переходит вместе с payments
+DO $$
+DECLARE
+    v_table REGCLASS;
+BEGIN
+    FOR v_table IN
+        SELECT inh.inhrelid::regclass
+        FROM pg_inherits inh
+        WHERE inh.inhparent = 'bankserviceschema.payments'::regclass
+    LOOP
+        EXECUTE format('ALTER TABLE %s OWNER TO bankservice', v_table);
+    END LOOP;
+END $$;
+
+ALTER TABLE bankserviceschema.payments OWNER TO bankservice;
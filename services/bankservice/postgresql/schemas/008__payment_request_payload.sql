@@ -0,0 +1,19 @@
+\connect fzon
+
+-- Ключ идемпотентности привязан к содержимому запроса: повтор с тем же ключом,
+-- но другим заказом, пользователем или суммой отклоняется, а не считается дублем.
+-- У ключей, принятых до миграции, содержимое берется из outbox, если запись еще там
+ALTER TABLE bankserviceschema.payment_requests
+    ADD COLUMN IF NOT EXISTS user_id INTEGER,
+    ADD COLUMN IF NOT EXISTS amount NUMERIC(10,2);
+
+UPDATE bankserviceschema.payment_requests r
+SET user_id = o.user_id,
+    amount = (o.payload->>'amount')::numeric(10,2)
+FROM (
+    SELECT DISTINCT ON (payload->>'order_id') payload->>'order_id' AS order_id, user_id, payload
+    FROM bankserviceschema.outbox
+    WHERE payload ? 'order_id' AND payload ? 'amount'
+    ORDER BY payload->>'order_id', id
+) o
+WHERE r.order_id = o.order_id::int AND r.user_id IS NULL;
@@ -1,9 +1,9 @@
 #include "GetBalance.hpp"
 
-#include <userver/storages/postgres/component.hpp>
 #include <userver/server/http/http_status.hpp>
 #include <userver/formats/json.hpp>
 #include <userver/clients/http/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
 
 namespace bankservice {
 
@@ -12,7 +12,8 @@ GetBalance::GetBalance(
     const userver::components::ComponentContext& component_context
 )
     : HttpHandlerBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      auth_url_(config["auth-url"].As<std::string>("http://authservice:8080/verify/")),
+      ledger_(component_context.FindComponent<Ledger>()),
       http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
 
 std::string GetBalance::HandleRequestThrow(
@@ -28,7 +29,7 @@ std::string GetBalance::HandleRequestThrow(
     try {
         auto response = http_client_.CreateRequest()
             .get()
-            .url("http://authservice:8080/verify/")
+            .url(auth_url_)
             .headers({{"Authorization", auth_header}})
             .timeout(std::chrono::seconds(2))
             .perform();
@@ -41,16 +42,7 @@ std::string GetBalance::HandleRequestThrow(
         const auto json_body = userver::formats::json::FromString(response->body());
         const auto user_id = json_body["user_id"].As<int>();
 
-        auto result = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            "SELECT balance::float8 FROM users WHERE user_id = $1",
-            user_id
-        );
-
-        double balance = 0.0;
-        if (result.Size() > 0) {
-            balance = result[0]["balance"].As<double>();
-        }
+        const auto balance = ledger_.GetBalance(user_id);
 
         request.SetResponseStatus(userver::server::http::HttpStatus::kOk);
         return userver::formats::json::ToString(
@@ -63,5 +55,18 @@ std::string GetBalance::HandleRequestThrow(
     }
 }
 
+userver::yaml_config::Schema GetBalance::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Current balance of the authorized user
+additionalProperties: false
+properties:
+    auth-url:
+        type: string
+        description: authservice handler that verifies the Authorization header
+        defaultDescription: http://authservice:8080/verify/
+)");
+}
+
 }  // namespace bankservice
 
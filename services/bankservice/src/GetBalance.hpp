@@ -3,7 +3,10 @@
 #include <userver/components/component.hpp>
 #include <userver/server/handlers/http_handler_base.hpp>
 #include <userver/clients/http/client.hpp>
-#include <userver/storages/postgres/cluster.hpp>
+
+#include <Ledger.hpp>
+
+#include <string>
 
 namespace bankservice {
 
@@ -16,8 +19,11 @@ public:
     std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
         const override;
 
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::string auth_url_;
+    Ledger& ledger_;
     userver::clients::http::Client& http_client_;
 };
 
@@ -0,0 +1,265 @@
+#include "Ledger.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/logging/log.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace bankservice {
+
+namespace {
+
+constexpr std::size_t kCacheWays = 16;
+
+// Блокировка журнала пользователя. Под ней записи пользователя коммитятся в порядке id,
+// поэтому MAX(id) пользователя отделяет учтенные записи от будущих.
+// user_ids отсортированы: блокировки берутся в одном порядке во всех транзакциях
+const std::string kLockQuery =
+    "SELECT pg_advisory_xact_lock(hashtext('bankservice_ledger'), u.user_id) "
+    "FROM UNNEST($1::int[]) AS u(user_id)";
+
+// Для пользователя с after_id < 0 база - снимок, иначе - баланс из памяти на записи after_id
+const std::string kReadQuery =
+    "SELECT u.user_id, s.balance::float8 AS snapshot_balance, s.ledger_id AS snapshot_id, "
+    "       d.delta::float8 AS delta, d.last_id "
+    "FROM UNNEST($1::int[], $2::bigint[]) AS u(user_id, after_id) "
+    "LEFT JOIN balance_snapshots s ON s.user_id = u.user_id AND u.after_id < 0 "
+    "CROSS JOIN LATERAL ("
+    "    SELECT COALESCE(SUM(l.amount), 0) AS delta, MAX(l.id) AS last_id "
+    "    FROM ledger l "
+    "    WHERE l.user_id = u.user_id "
+    "      AND l.id > CASE WHEN u.after_id < 0 THEN COALESCE(s.ledger_id, 0) ELSE u.after_id END"
+    ") d";
+
+double RoundCents(double value) {
+    return std::round(value * 100.0) / 100.0;
+}
+
+}  // namespace
+
+Ledger::Ledger(const components::ComponentConfig& config,
+               const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      snapshot_lookback_(config["snapshot-lookback"].As<std::chrono::milliseconds>(std::chrono::minutes{10})),
+      pg_cluster_(component_context.FindComponent<components::Postgres>("postgres-db-1").GetCluster()),
+      running_(kCacheWays, std::max<std::size_t>(config["max-active-users"].As<std::size_t>(100000) / kCacheWays, 1))
+{
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("ledger", [this](utils::statistics::Writer& writer) {
+        writer["appended"] = appended_.Load();
+        writer["cache-hits"] = cache_hits_.Load();
+        writer["cache-misses"] = cache_misses_.Load();
+        writer["write-throughs"] = write_throughs_.Load();
+        writer["last-snapshot-users"] = last_snapshot_users_.load();
+    });
+
+    utils::PeriodicTask::Settings settings{
+        config["snapshot-period"].As<std::chrono::milliseconds>(std::chrono::minutes{1})
+    };
+    snapshot_task_.Start("ledger-snapshot-task", settings, [this] { TakeSnapshots(); });
+}
+
+Ledger::~Ledger() {
+    snapshot_task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+std::vector<std::int64_t> Ledger::CachedIds(const std::vector<int>& user_ids,
+                                            std::unordered_map<int, Running>& cached) {
+    std::vector<std::int64_t> after_ids;
+    after_ids.reserve(user_ids.size());
+
+    for (const auto user_id : user_ids) {
+        if (auto running = running_.Get(user_id)) {
+            after_ids.push_back(running->ledger_id);
+            cached.emplace(user_id, *running);
+            cache_hits_.Add(utils::statistics::Rate{1});
+        } else {
+            after_ids.push_back(-1);
+            cache_misses_.Add(utils::statistics::Rate{1});
+        }
+    }
+    return after_ids;
+}
+
+std::unordered_map<int, double> Ledger::ApplyRead(const storages::postgres::ResultSet& result,
+                                                  const std::unordered_map<int, Running>& cached) {
+    std::unordered_map<int, double> balances;
+
+    for (const auto& row : result) {
+        const auto user_id = row["user_id"].As<int>();
+
+        Running running{0.0, 0};
+        const auto it = cached.find(user_id);
+        if (it != cached.end()) {
+            running = it->second;
+        } else {
+            running.balance = row["snapshot_balance"].As<std::optional<double>>().value_or(0.0);
+            running.ledger_id = row["snapshot_id"].As<std::optional<std::int64_t>>().value_or(0);
+        }
+
+        running.balance = RoundCents(running.balance + row["delta"].As<double>());
+        running.ledger_id = row["last_id"].As<std::optional<std::int64_t>>().value_or(running.ledger_id);
+
+        // Прочитаны только закоммиченные записи, поэтому пара баланс/версия верна
+        // независимо от исхода текущей транзакции
+        Remember(user_id, running);
+        balances[user_id] = running.balance;
+    }
+    return balances;
+}
+
+void Ledger::Remember(int user_id, const Running& running) {
+    // Более старая версия (например, прочитанная с отставшей реплики) не вытесняет новую.
+    // Проверка и запись не атомарны, но любая записанная пара баланс/версия согласована:
+    // следующее чтение доберет записи после нее
+    const auto current = running_.Get(user_id);
+    if (!current || current->ledger_id <= running.ledger_id) {
+        running_.Put(user_id, running);
+    }
+}
+
+void Ledger::WriteThrough(int user_id, double balance, std::int64_t ledger_id) {
+    Remember(user_id, {RoundCents(balance), ledger_id});
+    write_throughs_.Add(utils::statistics::Rate{1});
+}
+
+double Ledger::GetBalance(int user_id) {
+    const std::vector<int> user_ids{user_id};
+    std::unordered_map<int, Running> cached;
+    const auto after_ids = CachedIds(user_ids, cached);
+
+    const auto result = pg_cluster_->Execute(
+        storages::postgres::ClusterHostType::kSlave,
+        kReadQuery,
+        user_ids, after_ids
+    );
+    return ApplyRead(result, cached)[user_id];
+}
+
+void Ledger::TopUp(int user_id, double amount) {
+    auto transaction = pg_cluster_->Begin(
+        storages::postgres::ClusterHostType::kMaster,
+        storages::postgres::TransactionOptions{}
+    );
+
+    const auto balance = LockBalances(transaction, {user_id}).at(user_id) + amount;
+    const auto versions = Append(transaction, {{user_id, amount, kTopUp, std::nullopt}});
+
+    transaction.Commit();
+
+    WriteThrough(user_id, balance, versions.at(user_id));
+}
+
+std::unordered_map<int, double> Ledger::LockBalances(storages::postgres::Transaction& transaction,
+                                                     std::vector<int> user_ids) {
+    std::sort(user_ids.begin(), user_ids.end());
+    user_ids.erase(std::unique(user_ids.begin(), user_ids.end()), user_ids.end());
+
+    transaction.Execute(kLockQuery, user_ids);
+
+    std::unordered_map<int, Running> cached;
+    const auto after_ids = CachedIds(user_ids, cached);
+    return ApplyRead(transaction.Execute(kReadQuery, user_ids, after_ids), cached);
+}
+
+std::unordered_map<int, std::int64_t> Ledger::Append(storages::postgres::Transaction& transaction,
+                                                     const std::vector<Entry>& entries) {
+    std::unordered_map<int, std::int64_t> versions;
+    if (entries.empty()) {
+        return versions;
+    }
+
+    std::vector<int> user_ids;
+    std::vector<double> amounts;
+    std::vector<std::string> kinds;
+    std::vector<std::optional<int>> order_ids;
+    for (const auto& entry : entries) {
+        user_ids.push_back(entry.user_id);
+        amounts.push_back(entry.amount);
+        kinds.emplace_back(entry.kind);
+        order_ids.push_back(entry.order_id);
+    }
+
+    const auto result = transaction.Execute(
+        "INSERT INTO ledger (user_id, amount, kind, order_id) "
+        "SELECT e.user_id, e.amount::numeric, e.kind, e.order_id "
+        "FROM UNNEST($1::int[], $2::float8[], $3::text[], $4::int[]) AS e(user_id, amount, kind, order_id) "
+        "RETURNING id, user_id",
+        user_ids, amounts, kinds, order_ids
+    );
+
+    for (const auto& row : result) {
+        auto& version = versions[row["user_id"].As<int>()];
+        version = std::max(version, row["id"].As<std::int64_t>());
+    }
+
+    appended_.Add(utils::statistics::Rate{entries.size()});
+    return versions;
+}
+
+void Ledger::TakeSnapshots() {
+    try {
+        // Пересчитываются только пользователи с записями за snapshot-lookback; сумма при этом
+        // берется по всем записям после их снимка. Снимок не откатывается назад,
+        // если параллельно работает задача другой реплики
+        const auto result = pg_cluster_->Execute(
+            storages::postgres::ClusterHostType::kMaster,
+            "WITH active AS ("
+            "    SELECT DISTINCT user_id FROM ledger "
+            "    WHERE created_at > now() - $1 * interval '1 millisecond'"
+            "), totals AS ("
+            "    SELECT a.user_id, COALESCE(s.balance, 0) + d.delta AS balance, d.last_id "
+            "    FROM active a "
+            "    LEFT JOIN balance_snapshots s ON s.user_id = a.user_id "
+            "    CROSS JOIN LATERAL ("
+            "        SELECT SUM(l.amount) AS delta, MAX(l.id) AS last_id "
+            "        FROM ledger l "
+            "        WHERE l.user_id = a.user_id AND l.id > COALESCE(s.ledger_id, 0)"
+            "    ) d "
+            "    WHERE d.last_id IS NOT NULL"
+            ") "
+            "INSERT INTO balance_snapshots (user_id, balance, ledger_id, taken_at) "
+            "SELECT user_id, balance, last_id, now() FROM totals "
+            "ON CONFLICT (user_id) DO UPDATE SET "
+            "    balance = EXCLUDED.balance, ledger_id = EXCLUDED.ledger_id, taken_at = EXCLUDED.taken_at "
+            "WHERE balance_snapshots.ledger_id < EXCLUDED.ledger_id",
+            static_cast<std::int64_t>(snapshot_lookback_.count())
+        );
+
+        last_snapshot_users_ = static_cast<std::int64_t>(result.RowsAffected());
+        LOG_INFO() << "Ledger snapshots updated for " << result.RowsAffected() << " users";
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to update ledger snapshots: " << ex.what();
+    }
+}
+
+yaml_config::Schema Ledger::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Append-only balance ledger with periodic snapshots
+additionalProperties: false
+properties:
+    snapshot-period:
+        type: string
+        description: how often balance snapshots are brought up to date
+        defaultDescription: 1m
+    snapshot-lookback:
+        type: string
+        description: users with ledger entries newer than this get a fresh snapshot
+        defaultDescription: 10m
+    max-active-users:
+        type: integer
+        description: how many running balances are kept in memory
+        defaultDescription: 100000
+)");
+}
+
+}  // namespace bankservice
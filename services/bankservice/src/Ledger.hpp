@@ -0,0 +1,103 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/cache/nway_lru_cache.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/result_set.hpp>
+#include <userver/storages/postgres/transaction.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bankservice {
+
+// Балансы пользователей на append-only журнале ledger.
+// Пополнения и списания только дописываются, строки с балансом не обновляются.
+// Баланс = снимок из balance_snapshots + сумма записей после него. Снимки раз в snapshot-period
+// обновляет периодическая задача, а для активных пользователей в памяти держится
+// текущий баланс с версией - номером последней учтенной записи: чтение добирает только записи после нее.
+// Пополнения и списания после коммита сразу обновляют кэш (write-through).
+// GetBalance читает с реплики: при попадании в кэш запрос только сверяет версию,
+// при промахе берет снимок; отставшая реплика не откатывает более новую версию из кэша
+class Ledger final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "ledger";
+
+    static constexpr std::string_view kTopUp = "TOP_UP";
+    static constexpr std::string_view kPayment = "PAYMENT";
+
+    struct Entry {
+        int user_id;
+        // Пополнение положительное, списание отрицательное
+        double amount;
+        std::string_view kind;
+        std::optional<int> order_id;
+    };
+
+    Ledger(const components::ComponentConfig& config,
+           const components::ComponentContext& component_context);
+
+    ~Ledger() final;
+
+    // Текущий баланс пользователя; читает с реплики, мастер не нагружает
+    double GetBalance(int user_id);
+
+    // Пополнение в своей транзакции
+    void TopUp(int user_id, double amount);
+
+    // Блокирует балансы пользователей до конца транзакции и возвращает их.
+    // Записи пользователя дописываются только под этой блокировкой
+    std::unordered_map<int, double> LockBalances(storages::postgres::Transaction& transaction,
+                                                 std::vector<int> user_ids);
+
+    // Дописывает записи одним запросом; пользователи должны быть заблокированы LockBalances.
+    // Возвращает номер последней записи каждого пользователя - новую версию его баланса
+    std::unordered_map<int, std::int64_t> Append(storages::postgres::Transaction& transaction,
+                                                 const std::vector<Entry>& entries);
+
+    // Запоминает баланс пользователя после коммита транзакции, дописавшей записи до ledger_id
+    void WriteThrough(int user_id, double balance, std::int64_t ledger_id);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    struct Running {
+        double balance;
+        // Последняя учтенная запись ledger
+        std::int64_t ledger_id;
+    };
+
+    // Аргументы запроса чтения: для пользователей из памяти - номер учтенной записи, иначе -1
+    std::vector<std::int64_t> CachedIds(const std::vector<int>& user_ids,
+                                        std::unordered_map<int, Running>& cached);
+    std::unordered_map<int, double> ApplyRead(const storages::postgres::ResultSet& result,
+                                              const std::unordered_map<int, Running>& cached);
+    void Remember(int user_id, const Running& running);
+    void TakeSnapshots();
+
+    const std::chrono::milliseconds snapshot_lookback_;
+
+    storages::postgres::ClusterPtr pg_cluster_;
+    cache::NWayLRU<int, Running> running_;
+
+    utils::statistics::RateCounter appended_;
+    utils::statistics::RateCounter cache_hits_;
+    utils::statistics::RateCounter cache_misses_;
+    utils::statistics::RateCounter write_throughs_;
+    std::atomic<std::int64_t> last_snapshot_users_{0};
+
+    utils::PeriodicTask snapshot_task_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace bankservice
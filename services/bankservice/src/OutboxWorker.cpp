@@ -2,144 +2,79 @@
 
 #include <userver/components/component.hpp>
 #include <userver/clients/http/component.hpp>
-#include <userver/storages/postgres/component.hpp>
+#include <userver/dynamic_config/value.hpp>
 
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
 #include <userver/formats/json.hpp>
-#include <userver/utils/async.hpp>
+#include <userver/logging/log.hpp>
 
 #include <chrono>
-#include <thread>
-#include <random>
+#include <stdexcept>
 
 namespace bankservice {
 
-OutboxWorker::OutboxWorker(
-    const components::ComponentConfig& config,
-    const components::ComponentContext& component_context)
-    : components::ComponentBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
-      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient())
-{
-    std::srand(std::time(nullptr));
-    utils::PeriodicTask::Settings settings{std::chrono::seconds{1}};
-    periodic_task_.Start("bank-outbox-task", settings, [this] { DoWork(); });
+namespace {
+
+// Значения по умолчанию продублированы в секции dynamic-config static_config.yaml
+const dynamic_config::Key<std::int64_t> kOutboxBatchSize{"BANKSERVICE_OUTBOX_BATCH_SIZE", 32};
+const dynamic_config::Key<std::int64_t> kOutboxPollIntervalMs{"BANKSERVICE_OUTBOX_POLL_INTERVAL_MS", 10000};
+
+}  // namespace
+
+outbox::DynamicConfigKeys OutboxHandler::ConfigKeys() {
+    return {kOutboxBatchSize, kOutboxPollIntervalMs};
 }
 
-OutboxWorker::~OutboxWorker() {
-    periodic_task_.Stop();
+OutboxHandler::OutboxHandler(const components::ComponentConfig& config,
+                             const components::ComponentContext& component_context)
+    : delivery_timeout_(config["delivery-timeout"].As<std::chrono::milliseconds>(std::chrono::seconds{5})),
+      payment_result_url_(config["delivery-url"].As<std::string>("http://orderservice:8080/payment-result")),
+      simulator_(component_context.FindComponent<PaymentSimulator>()),
+      settlement_(component_context.FindComponent<Settlement>()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient())
+{}
+
+std::optional<formats::json::Value> OutboxHandler::Process(storages::postgres::Transaction&,
+                                                           const outbox::Record& record) {
+    return record.payload;
 }
 
-void OutboxWorker::DoWork() {
-    try {
-        auto transaction = pg_cluster_->Begin(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            userver::storages::postgres::TransactionOptions{}
-        );
-
-        auto result = transaction.Execute(
-            "SELECT id, user_id, payload FROM outbox "
-            "WHERE processed = false ORDER BY id FOR UPDATE SKIP LOCKED LIMIT 10"
-        );
-
-        if (result.Size() == 0) {
-            transaction.Rollback();
-            return;
-        }
-
-        for (const auto& row : result) {
-            const auto outbox_id = row["id"].As<int>();
-            const auto user_id   = row["user_id"].As<int>();
-            const auto payload   = row["payload"].As<userver::formats::json::Value>();
-
-            try {
-                transaction.Execute("SAVEPOINT outbox_record_" + std::to_string(outbox_id));
-
-                const auto order_id = payload["order_id"].As<int>();
-                const auto amount   = payload["amount"].As<double>();
-
-                std::this_thread::sleep_for(std::chrono::seconds(9)); // имитация долгой обработки
-
-                auto user_res = transaction.Execute(
-                    "SELECT balance::float8 FROM users WHERE user_id = $1",
-                    user_id
-                );
-
-                std::string status = "INSUFFICIENT_FUNDS";
-
-                if (user_res.Size() > 0) {
-                    double balance = user_res[0]["balance"].As<double>();
-                    if (balance >= amount) {
-                        if (std::rand() % 2 == 0) {
-                            transaction.Execute(
-                                "UPDATE users SET balance = balance - $1 WHERE user_id = $2",
-                                amount, user_id
-                            );
-
-                            status = "PAID";
-                        }
-                        else {
-                            status = "FAILED";
-                        }
-                    }
-                }
-
-                transaction.Execute(
-                    "INSERT INTO payments (order_id, user_id, amount, status) "
-                    "VALUES ($1, $2, $3, $4)",
-                    order_id, user_id, amount, status
-                );
-
-                transaction.Execute(
-                    "UPDATE outbox SET processed = true WHERE id = $1",
-                    outbox_id
-                );
-
-                // уведомляем orderservice
-                // TODO: вынести в отдельный таск-процессор
-                userver::formats::json::ValueBuilder res_json;
-                res_json["order_id"] = order_id;
-                res_json["status"]   = status;
-
-                try {
-                    auto response = http_client_.CreateRequest()
-                        .post()
-                        .url("http://orderservice:8080/payment-result")
-                        .data(userver::formats::json::ToString(res_json.ExtractValue()))
-                        .timeout(std::chrono::seconds(5))
-                        .perform();
-
-                    if (response->status_code() != 204) {
-                        LOG_INFO() << "Sent payment result to orderservice successfuly";
-                    } else {
-                        LOG_WARNING() << "Payment result service returned status: "
-                                      << response->status_code();
-                    }
-
-                } catch (const std::exception& ex) {
-                    LOG_ERROR() << "Failed to send payment result: " << ex.what();
-                }
-
-            } catch (const std::exception& ex) {
-                LOG_ERROR() << "Error processing bank outbox record " << outbox_id << ": " << ex.what();
-                transaction.Execute("ROLLBACK TO SAVEPOINT outbox_record_" + std::to_string(outbox_id));
-            }
-        }
-
-        transaction.Commit();
-
-    } catch (const std::exception& ex) {
-        LOG_ERROR() << "Error in OutboxWorker DoWork: " << ex.what();
+void OutboxHandler::Deliver(const outbox::Record& record, const formats::json::Value& message) {
+    const auto order_id = message["order_id"].As<int>();
+
+    // Записи, обработанные до переноса оплаты на этап доставки, уже содержат готовый результат
+    auto status = message["status"].As<std::string>("");
+    if (status.empty()) {
+        const auto decision = simulator_.Decide(order_id);
+
+        // Корутина засыпает, не занимая поток и не держа транзакцию
+        engine::InterruptibleSleepFor(decision.latency);
+        engine::current_task::CancellationPoint();
+
+        status = settlement_.Settle({
+            record.id, order_id, record.user_id, message["amount"].As<double>(), decision.outcome
+        });
     }
-}
 
-yaml_config::Schema OutboxWorker::GetStaticConfigSchema() {
-    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
-type: object
-description: Bank OutboxWorker component
-additionalProperties: false
-properties: {}
-)");
+    userver::formats::json::ValueBuilder res_json;
+    res_json["order_id"] = order_id;
+    res_json["status"]   = status;
+
+    auto response = http_client_.CreateRequest()
+        .post()
+        .url(payment_result_url_)
+        .data(userver::formats::json::ToString(res_json.ExtractValue()))
+        .timeout(delivery_timeout_)
+        .perform();
+
+    if (response->status_code() != 204) {
+        throw std::runtime_error("orderservice returned status " + std::to_string(response->status_code()));
+    }
+
+    LOG_INFO() << "Sent payment result for order " << order_id << " to orderservice";
 }
 
-}  // namespace bankservice
+void OutboxHandler::OnCommitted(const std::vector<outbox::Record>&) {}
 
+}  // namespace bankservice
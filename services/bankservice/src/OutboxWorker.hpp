@@ -1,35 +1,55 @@
 #pragma once
 
 #include <userver/utest/using_namespace_userver.hpp>
-#include <userver/components/component_base.hpp>
-#include <userver/utils/periodic_task.hpp>
-#include <userver/logging/log.hpp>
-#include <userver/yaml_config/merge_schemas.hpp>
-
 #include <userver/clients/http/client.hpp>
-#include <userver/storages/postgres/cluster.hpp>
+
+#include <outbox/Consumer.hpp>
+
+#include <PaymentSimulator.hpp>
+#include <Settlement.hpp>
+
+#include <chrono>
+#include <string>
 
 
 namespace bankservice {
 
-class OutboxWorker final : public components::ComponentBase {
+// Обработчик outbox банка: проводит платеж и сообщает результат в orderservice.
+// Разбор, повторы и доставку делает общий outbox::Consumer, просыпаясь по NOTIFY из Payment.
+// Платеж проводится на этапе доставки, вне транзакции пачки: имитация долгой обработки
+// (исход и задержку задает PaymentSimulator) не держит транзакцию и соединение, а записи пачки
+// идут параллельно (max-parallel-deliveries). Списание и запись платежа делает Settlement
+// одной транзакцией на пачку одновременно завершившихся доставок
+class OutboxHandler final {
 public:
     static constexpr std::string_view kName = "outbox-worker";
+    static constexpr std::string_view kTable = "outbox";
 
-    OutboxWorker(const components::ComponentConfig& config,
-                 const components::ComponentContext& component_context);
+    // Канал, в который Payment отправляет pg_notify вместе со вставкой в outbox
+    static constexpr std::string_view kNotifyChannel = "bankservice_outbox";
 
-    ~OutboxWorker() final;
+    static outbox::DynamicConfigKeys ConfigKeys();
 
-    static yaml_config::Schema GetStaticConfigSchema();
+    OutboxHandler(const components::ComponentConfig& config,
+                  const components::ComponentContext& component_context);
 
-private:
-    void DoWork();
+    // Передает запрос на оплату на этап доставки
+    std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                const outbox::Record& record);
 
-    utils::PeriodicTask periodic_task_;
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    // Проводит платеж через Settlement, если он еще не проведен, и отправляет результат оплаты в orderservice
+    void Deliver(const outbox::Record& record, const formats::json::Value& message);
+
+    void OnCommitted(const std::vector<outbox::Record>& records);
+
+private:
+    const std::chrono::milliseconds delivery_timeout_;
+    const std::string payment_result_url_;
+    PaymentSimulator& simulator_;
+    Settlement& settlement_;
     userver::clients::http::Client& http_client_;
 };
 
-}  // namespace bankservice
+using OutboxWorker = outbox::Consumer<OutboxHandler>;
 
+}  // namespace bankservice
@@ -1,16 +1,48 @@
 #include "Payment.hpp"
 
+#include <userver/components/statistics_storage.hpp>
 #include <userver/storages/postgres/component.hpp>
 #include <userver/formats/json.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <OutboxWorker.hpp>
+
+#include <algorithm>
 
 namespace bankservice {
 
+namespace {
+
+constexpr std::size_t kRecentKeysWays = 16;
+// Длина колонки payment_requests.idempotency_key
+constexpr std::size_t kMaxKeyLength = 128;
+
+}  // namespace
+
 Payment::Payment(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& component_context
 )
     : HttpHandlerBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()) {}
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      recent_keys_(
+          kRecentKeysWays,
+          std::max<std::size_t>(config["recent-keys"].As<std::size_t>(100000) / kRecentKeysWays, 1)
+      )
+{
+    auto& storage = component_context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("payment-intake", [this](userver::utils::statistics::Writer& writer) {
+        writer["accepted"] = accepted_.Load();
+        writer["duplicates-filtered"] = duplicates_filtered_.Load();
+        writer["duplicates-db"] = duplicates_db_.Load();
+        writer["key-mismatches"] = key_mismatches_.Load();
+    });
+}
+
+Payment::~Payment() {
+    statistics_holder_.Unregister();
+}
 
 std::string Payment::HandleRequestThrow(
     const userver::server::http::HttpRequest& request,
@@ -23,14 +55,84 @@ std::string Payment::HandleRequestThrow(
         const auto user_id  = body_json["user_id"].As<int>();
         const auto amount   = body_json["amount"].As<double>();
 
-        // сохраняем в outbox
-        pg_cluster_->Execute(
+        auto key = request.GetHeader("Idempotency-Key");
+        if (key.empty()) {
+            key = "order:" + std::to_string(order_id);
+        }
+        if (key.size() > kMaxKeyLength) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return R"({"error": "idempotency key is too long"})";
+        }
+
+        const RequestPayload payload{order_id, user_id, amount};
+
+        if (const auto recent = recent_keys_.Get(key)) {
+            if (!(*recent == payload)) {
+                key_mismatches_.Add(userver::utils::statistics::Rate{1});
+                LOG_WARNING() << "Idempotency key " << key << " reused for a different payment of order " << order_id;
+                request.SetResponseStatus(userver::server::http::HttpStatus::kUnprocessableEntity);
+                return R"({"error": "idempotency key was used for a different payment"})";
+            }
+            duplicates_filtered_.Add(userver::utils::statistics::Rate{1});
+            LOG_INFO() << "Duplicate payment request for order " << order_id << " filtered in memory";
+            request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
+            return "";
+        }
+
+        // Ключ, запись в outbox и уведомление OutboxWorker - в одной транзакции:
+        // при занятом ключе outbox не трогается, уведомление придет только после коммита вставки
+        const auto result = pg_cluster_->Execute(
             userver::storages::postgres::ClusterHostType::kMaster,
-            "INSERT INTO outbox (user_id, payload) VALUES ($1, $2::jsonb)",
+            "WITH request AS ("
+            "    INSERT INTO payment_requests (idempotency_key, order_id, user_id, amount) "
+            "    VALUES ($1, $2, $3, $6::numeric(10,2)) "
+            "    ON CONFLICT (idempotency_key) DO NOTHING "
+            "    RETURNING idempotency_key"
+            "), inserted AS ("
+            "    INSERT INTO outbox (user_id, payload) "
+            "    SELECT $3, $4::jsonb FROM request "
+            "    RETURNING id"
+            ") "
+            "SELECT pg_notify($5, id::text) FROM inserted",
+            key,
+            order_id,
             user_id,
-            body_json
+            body_json,
+            std::string{OutboxWorker::kNotifyChannel},
+            amount
         );
 
+        if (result.Size() == 0) {
+            // Ключ уже занят: это дубль, только если он принят для того же платежа.
+            // У ключей до миграции 008 пользователя и суммы может не быть
+            const auto same_payment = pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "SELECT order_id = $2 "
+                "       AND (user_id IS NULL OR user_id = $3) "
+                "       AND (amount IS NULL OR amount = $4::numeric(10,2)) "
+                "FROM payment_requests WHERE idempotency_key = $1",
+                key,
+                order_id,
+                user_id,
+                amount
+            ).AsSingleRow<bool>();
+
+            if (!same_payment) {
+                key_mismatches_.Add(userver::utils::statistics::Rate{1});
+                LOG_WARNING() << "Idempotency key " << key << " reused for a different payment of order " << order_id;
+                request.SetResponseStatus(userver::server::http::HttpStatus::kUnprocessableEntity);
+                return R"({"error": "idempotency key was used for a different payment"})";
+            }
+
+            recent_keys_.Put(key, payload);
+            duplicates_db_.Add(userver::utils::statistics::Rate{1});
+            LOG_INFO() << "Duplicate payment request for order " << order_id << " rejected by key " << key;
+        } else {
+            recent_keys_.Put(key, payload);
+            accepted_.Add(userver::utils::statistics::Rate{1});
+            LOG_INFO() << "Accepted payment request for order " << order_id << ", amount " << amount;
+        }
+
         request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
         return "";
 
@@ -41,5 +143,17 @@ std::string Payment::HandleRequestThrow(
     }
 }
 
-}  // namespace bankservice
+userver::yaml_config::Schema Payment::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Idempotent intake of payment requests
+additionalProperties: false
+properties:
+    recent-keys:
+        type: integer
+        description: how many recently accepted idempotency keys are kept in memory
+        defaultDescription: 100000
+)");
+}
 
+}  // namespace bankservice
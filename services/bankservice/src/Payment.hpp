@@ -1,11 +1,21 @@
 #pragma once
 
+#include <userver/cache/nway_lru_cache.hpp>
 #include <userver/components/component.hpp>
 #include <userver/server/handlers/http_handler_base.hpp>
 #include <userver/storages/postgres/cluster.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+
+#include <string>
 
 namespace bankservice {
 
+// Прием запроса на оплату. Запрос идемпотентен по ключу: заголовок Idempotency-Key,
+// а без него - order:<order_id>. Ключ и запись outbox вставляются одним запросом,
+// повтор с тем же ключом не создает второй платеж и тоже получает 204.
+// Ключ привязан к заказу, пользователю и сумме: тот же ключ с другим содержимым получает 422.
+// Недавно принятые ключи помнятся в памяти, их повторы отсекаются без обращения к базе
 class Payment final : public userver::server::handlers::HttpHandlerBase {
 public:
     static constexpr std::string_view kName = "handler-payment";
@@ -13,13 +23,35 @@ public:
     Payment(const userver::components::ComponentConfig&,
             const userver::components::ComponentContext&);
 
+    ~Payment() override;
+
     std::string HandleRequestThrow(
         const userver::server::http::HttpRequest&,
         userver::server::request::RequestContext&) const override;
 
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
 private:
     userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    // Содержимое запроса, к которому привязан ключ
+    struct RequestPayload {
+        int order_id{0};
+        int user_id{0};
+        double amount{0.0};
+
+        bool operator==(const RequestPayload& other) const {
+            return order_id == other.order_id && user_id == other.user_id && amount == other.amount;
+        }
+    };
+
+    mutable userver::cache::NWayLRU<std::string, RequestPayload> recent_keys_;
+
+    mutable userver::utils::statistics::RateCounter accepted_;
+    mutable userver::utils::statistics::RateCounter duplicates_filtered_;
+    mutable userver::utils::statistics::RateCounter duplicates_db_;
+    mutable userver::utils::statistics::RateCounter key_mismatches_;
+    userver::utils::statistics::Entry statistics_holder_;
 };
 
 }  // namespace bankservice
-
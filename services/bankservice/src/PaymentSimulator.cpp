@@ -0,0 +1,249 @@
+#include "PaymentSimulator.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/dynamic_config/storage/component.hpp>
+#include <userver/dynamic_config/value.hpp>
+#include <userver/formats/parse/common_containers.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace bankservice {
+
+namespace {
+
+// Значение по умолчанию продублировано в секции dynamic-config static_config.yaml.
+// Пустая строка - профиль из статического конфига
+const dynamic_config::Key<std::string> kProfile{"BANKSERVICE_PAYMENT_SIMULATOR_PROFILE", std::string{}};
+
+// splitmix64: соседние номера заказов дают независимые начальные состояния генератора
+std::uint64_t Mix(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+std::chrono::milliseconds SampleLatency(const PaymentSimulator::Latency& latency, std::mt19937_64& rng) {
+    using Distribution = PaymentSimulator::LatencyDistribution;
+
+    double ms = 0.0;
+    switch (latency.distribution) {
+        case Distribution::kFixed:
+            return latency.value;
+        case Distribution::kUniform:
+            ms = std::uniform_real_distribution<double>{
+                static_cast<double>(latency.min.count()),
+                static_cast<double>(latency.max.count())
+            }(rng);
+            break;
+        case Distribution::kLogNormal:
+            ms = std::lognormal_distribution<double>{
+                std::log(static_cast<double>(latency.median.count())),
+                latency.sigma
+            }(rng);
+            break;
+        case Distribution::kHeavyTail: {
+            // Обратная функция распределения Парето
+            const double u = std::uniform_real_distribution<double>{0.0, 1.0}(rng);
+            ms = static_cast<double>(latency.min.count()) / std::pow(1.0 - u, 1.0 / latency.alpha);
+            break;
+        }
+    }
+
+    if (latency.max.count() > 0) {
+        ms = std::min(ms, static_cast<double>(latency.max.count()));
+    }
+    return std::chrono::milliseconds{static_cast<std::int64_t>(ms)};
+}
+
+}  // namespace
+
+PaymentSimulator::Latency Parse(const yaml_config::YamlConfig& value,
+                                formats::parse::To<PaymentSimulator::Latency>) {
+    using Distribution = PaymentSimulator::LatencyDistribution;
+
+    PaymentSimulator::Latency latency;
+    const auto distribution = value["distribution"].As<std::string>("fixed");
+
+    latency.value = value["value"].As<std::chrono::milliseconds>(std::chrono::milliseconds{0});
+    latency.min = value["min"].As<std::chrono::milliseconds>(std::chrono::milliseconds{0});
+    latency.max = value["max"].As<std::chrono::milliseconds>(std::chrono::milliseconds{0});
+    latency.median = value["median"].As<std::chrono::milliseconds>(std::chrono::milliseconds{0});
+    latency.sigma = value["sigma"].As<double>(0.0);
+    latency.alpha = value["alpha"].As<double>(0.0);
+
+    if (distribution == "fixed") {
+        latency.distribution = Distribution::kFixed;
+    } else if (distribution == "uniform") {
+        latency.distribution = Distribution::kUniform;
+        if (latency.max < latency.min) {
+            throw std::runtime_error("uniform latency at " + value.GetPath() + " requires min <= max");
+        }
+    } else if (distribution == "lognormal") {
+        latency.distribution = Distribution::kLogNormal;
+        if (latency.median.count() <= 0 || latency.sigma < 0.0) {
+            throw std::runtime_error("lognormal latency at " + value.GetPath() + " requires median > 0 and sigma >= 0");
+        }
+    } else if (distribution == "heavy-tail") {
+        latency.distribution = Distribution::kHeavyTail;
+        if (latency.min.count() <= 0 || latency.alpha <= 0.0) {
+            throw std::runtime_error("heavy-tail latency at " + value.GetPath() + " requires min > 0 and alpha > 0");
+        }
+    } else {
+        throw std::runtime_error("unknown latency distribution '" + distribution + "' at " + value.GetPath());
+    }
+
+    return latency;
+}
+
+PaymentSimulator::Profile Parse(const yaml_config::YamlConfig& value,
+                                formats::parse::To<PaymentSimulator::Profile>) {
+    PaymentSimulator::Profile profile;
+    profile.success = value["success"].As<double>(1.0);
+    profile.failure = value["failure"].As<double>(0.0);
+    profile.insufficient_funds = value["insufficient-funds"].As<double>(0.0);
+    profile.latency = value["latency"].As<PaymentSimulator::Latency>();
+
+    if (profile.success < 0.0 || profile.failure < 0.0 || profile.insufficient_funds < 0.0 ||
+        profile.success + profile.failure + profile.insufficient_funds <= 0.0) {
+        throw std::runtime_error("outcome weights at " + value.GetPath() + " must be non-negative with a positive sum");
+    }
+
+    return profile;
+}
+
+PaymentSimulator::PaymentSimulator(const components::ComponentConfig& config,
+                                   const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      seed_(config["seed"].As<std::uint64_t>(0)),
+      default_profile_(config["profile"].As<std::string>("default")),
+      profiles_(config["profiles"].As<std::unordered_map<std::string, Profile>>()),
+      config_source_(component_context.FindComponent<components::DynamicConfig>().GetSource())
+{
+    if (!profiles_.count(default_profile_)) {
+        throw std::runtime_error("payment-simulator profile '" + default_profile_ + "' is not defined");
+    }
+
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("payment-simulator", [this](utils::statistics::Writer& writer) {
+        writer["success"] = successes_.Load();
+        writer["failure"] = failures_.Load();
+        writer["insufficient-funds"] = insufficient_funds_.Load();
+        writer["latency-ms"] = latency_ms_.Load();
+    });
+}
+
+PaymentSimulator::~PaymentSimulator() {
+    statistics_holder_.Unregister();
+}
+
+const PaymentSimulator::Profile& PaymentSimulator::ActiveProfile() const {
+    const auto name = config_source_.GetCopy(kProfile);
+    if (!name.empty()) {
+        const auto it = profiles_.find(name);
+        if (it != profiles_.end()) {
+            return it->second;
+        }
+        LOG_LIMITED_WARNING() << "Unknown payment simulator profile '" << name
+                              << "', using '" << default_profile_ << "'";
+    }
+    return profiles_.at(default_profile_);
+}
+
+PaymentSimulator::Decision PaymentSimulator::Decide(int order_id) {
+    const auto& profile = ActiveProfile();
+
+    // Генератор на каждое решение: результат не зависит от того, какие платежи
+    // и в каком порядке разбирались до этого
+    std::mt19937_64 rng{Mix(seed_ ^ Mix(static_cast<std::uint64_t>(order_id)))};
+
+    const double total = profile.success + profile.failure + profile.insufficient_funds;
+    const double roll = std::uniform_real_distribution<double>{0.0, total}(rng);
+
+    Decision decision{Outcome::kInsufficientFunds, SampleLatency(profile.latency, rng)};
+    if (roll < profile.success) {
+        decision.outcome = Outcome::kSuccess;
+        successes_.Add(utils::statistics::Rate{1});
+    } else if (roll < profile.success + profile.failure) {
+        decision.outcome = Outcome::kFailure;
+        failures_.Add(utils::statistics::Rate{1});
+    } else {
+        insufficient_funds_.Add(utils::statistics::Rate{1});
+    }
+    latency_ms_.Add(utils::statistics::Rate{static_cast<std::uint64_t>(decision.latency.count())});
+
+    return decision;
+}
+
+yaml_config::Schema PaymentSimulator::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Deterministic payment processing simulator
+additionalProperties: false
+properties:
+    seed:
+        type: integer
+        description: seed of the outcome and latency generator
+        defaultDescription: 0
+    profile:
+        type: string
+        description: profile used when BANKSERVICE_PAYMENT_SIMULATOR_PROFILE is empty
+        defaultDescription: default
+    profiles:
+        type: object
+        description: simulator profiles by name
+        properties: {}
+        additionalProperties:
+            type: object
+            description: outcome weights and latency distribution
+            additionalProperties: false
+            properties:
+                success:
+                    type: number
+                    description: weight of successful payments
+                    defaultDescription: 1
+                failure:
+                    type: number
+                    description: weight of declined payments
+                    defaultDescription: 0
+                insufficient-funds:
+                    type: number
+                    description: weight of payments declined for insufficient funds
+                    defaultDescription: 0
+                latency:
+                    type: object
+                    description: processing latency distribution
+                    additionalProperties: false
+                    properties:
+                        distribution:
+                            type: string
+                            description: fixed, uniform, lognormal or heavy-tail
+                            defaultDescription: fixed
+                        value:
+                            type: string
+                            description: latency of the fixed distribution
+                        min:
+                            type: string
+                            description: lower bound of uniform, scale of heavy-tail
+                        max:
+                            type: string
+                            description: upper bound of uniform, cap of the other distributions
+                        median:
+                            type: string
+                            description: median of lognormal
+                        sigma:
+                            type: number
+                            description: sigma of the underlying normal for lognormal
+                        alpha:
+                            type: number
+                            description: shape of heavy-tail, smaller means heavier tail
+)");
+}
+
+}  // namespace bankservice
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/dynamic_config/source.hpp>
+#include <userver/formats/parse/to.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+#include <userver/yaml_config/yaml_config.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace bankservice {
+
+// Имитация внешнего процессинга платежей: исход и время обработки.
+// Профили (доли исходов и распределение задержки) описываются в static_config.yaml,
+// активный профиль выбирается динамическим конфигом BANKSERVICE_PAYMENT_SIMULATOR_PROFILE.
+// Решение детерминировано: зависит только от seed и номера заказа, поэтому прогон
+// с тем же seed дает те же исходы независимо от порядка и параллельности доставки
+class PaymentSimulator final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "payment-simulator";
+
+    enum class Outcome {
+        kSuccess,
+        // Отказ банка-эмитента при достаточном балансе
+        kFailure,
+        // Отказ по недостатку средств независимо от баланса
+        kInsufficientFunds,
+    };
+
+    enum class LatencyDistribution {
+        kFixed,
+        kUniform,
+        kLogNormal,
+        // Парето: большинство платежей быстрые, редкие - очень долгие
+        kHeavyTail,
+    };
+
+    struct Latency {
+        LatencyDistribution distribution{LatencyDistribution::kFixed};
+        // fixed
+        std::chrono::milliseconds value{0};
+        // uniform: диапазон; heavy-tail: min - масштаб распределения
+        std::chrono::milliseconds min{0};
+        // Верхняя граница для всех распределений, кроме fixed
+        std::chrono::milliseconds max{0};
+        // lognormal
+        std::chrono::milliseconds median{0};
+        double sigma{0.0};
+        // heavy-tail
+        double alpha{0.0};
+    };
+
+    struct Profile {
+        // Веса исходов, нормировать не обязательно
+        double success{1.0};
+        double failure{0.0};
+        double insufficient_funds{0.0};
+        Latency latency;
+    };
+
+    struct Decision {
+        Outcome outcome;
+        std::chrono::milliseconds latency;
+    };
+
+    PaymentSimulator(const components::ComponentConfig& config,
+                     const components::ComponentContext& component_context);
+
+    ~PaymentSimulator() final;
+
+    // Исход и задержка обработки платежа по заказу order_id в активном профиле
+    Decision Decide(int order_id);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    const Profile& ActiveProfile() const;
+
+    const std::uint64_t seed_;
+    const std::string default_profile_;
+    const std::unordered_map<std::string, Profile> profiles_;
+
+    dynamic_config::Source config_source_;
+
+    utils::statistics::RateCounter successes_;
+    utils::statistics::RateCounter failures_;
+    utils::statistics::RateCounter insufficient_funds_;
+    utils::statistics::RateCounter latency_ms_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+PaymentSimulator::Latency Parse(const yaml_config::YamlConfig& value,
+                                formats::parse::To<PaymentSimulator::Latency>);
+
+PaymentSimulator::Profile Parse(const yaml_config::YamlConfig& value,
+                                formats::parse::To<PaymentSimulator::Profile>);
+
+}  // namespace bankservice
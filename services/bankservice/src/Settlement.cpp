@@ -0,0 +1,232 @@
+#include "Settlement.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/async.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+namespace bankservice {
+
+namespace {
+
+std::string Decide(PaymentSimulator::Outcome outcome, double& balance, double amount) {
+    if (outcome == PaymentSimulator::Outcome::kInsufficientFunds || balance < amount) {
+        return "INSUFFICIENT_FUNDS";
+    }
+    if (outcome == PaymentSimulator::Outcome::kFailure) {
+        return "FAILED";
+    }
+    balance -= amount;
+    return "PAID";
+}
+
+}  // namespace
+
+Settlement::Settlement(const components::ComponentConfig& config,
+                       const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      max_batch_size_(config["max-batch-size"].As<std::size_t>(256)),
+      flush_interval_(config["flush-interval"].As<std::chrono::milliseconds>(std::chrono::milliseconds{5})),
+      pg_cluster_(component_context.FindComponent<components::Postgres>("postgres-db-1").GetCluster()),
+      ledger_(component_context.FindComponent<Ledger>())
+{
+    if (max_batch_size_ == 0) {
+        throw std::runtime_error(std::string{config.Name()} + ": max-batch-size must be positive");
+    }
+
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("settlement", [this](utils::statistics::Writer& writer) {
+        writer["batches"] = batches_.Load();
+        writer["settled"] = settled_.Load();
+        writer["failures"] = failures_.Load();
+    });
+
+    flush_task_ = utils::CriticalAsync("settlement-flush", [this] { Run(); });
+}
+
+Settlement::~Settlement() {
+    flush_task_.SyncCancel();
+    statistics_holder_.Unregister();
+}
+
+std::string Settlement::Settle(const Payment& payment) {
+    engine::Future<std::string> future;
+    {
+        std::unique_lock lock(mutex_);
+        queue_.push_back({payment, {}});
+        future = queue_.back().promise.get_future();
+        // Будим задачу на первом платеже пачки и когда пачка заполнилась
+        if (queue_.size() == 1 || queue_.size() >= max_batch_size_) {
+            queue_cv_.NotifyOne();
+        }
+    }
+    return future.get();
+}
+
+void Settlement::Run() {
+    while (!engine::current_task::ShouldCancel()) {
+        std::vector<Pending> batch;
+        {
+            std::unique_lock lock(mutex_);
+            if (!queue_cv_.Wait(lock, [this] { return !queue_.empty(); })) {
+                break;  // Задачу отменили
+            }
+            // Даем пачке набраться: параллельные доставки приходят почти одновременно
+            queue_cv_.WaitFor(lock, flush_interval_, [this] { return queue_.size() >= max_batch_size_; });
+
+            const auto size = std::min(queue_.size(), max_batch_size_);
+            batch.reserve(size);
+            std::move(queue_.begin(), queue_.begin() + size, std::back_inserter(batch));
+            queue_.erase(queue_.begin(), queue_.begin() + size);
+        }
+
+        Flush(batch);
+    }
+}
+
+void Settlement::Flush(std::vector<Pending>& batch) {
+    // Платежи пользователя решаются по порядку заказов
+    std::sort(batch.begin(), batch.end(), [](const Pending& lhs, const Pending& rhs) {
+        return std::tie(lhs.payment.user_id, lhs.payment.order_id) <
+               std::tie(rhs.payment.user_id, rhs.payment.order_id);
+    });
+
+    std::vector<int> user_ids;
+    std::vector<int> order_ids;
+    for (const auto& pending : batch) {
+        if (user_ids.empty() || user_ids.back() != pending.payment.user_id) {
+            user_ids.push_back(pending.payment.user_id);
+        }
+        order_ids.push_back(pending.payment.order_id);
+    }
+
+    std::vector<std::string> statuses(batch.size());
+    // Балансы после пачки и их новые версии для кэша Ledger
+    std::unordered_map<int, double> balances;
+    std::unordered_map<int, std::int64_t> versions;
+
+    try {
+        auto transaction = pg_cluster_->Begin(
+            storages::postgres::ClusterHostType::kMaster,
+            storages::postgres::TransactionOptions{}
+        );
+
+        balances = ledger_.LockBalances(transaction, user_ids);
+
+        // Уже проведенные платежи (повторная доставка) не проводятся второй раз
+        auto payments_res = transaction.Execute(
+            "SELECT order_id, status FROM payments WHERE order_id = ANY($1)",
+            order_ids
+        );
+        std::unordered_map<int, std::string> settled;
+        for (const auto& row : payments_res) {
+            settled.emplace(row["order_id"].As<int>(), row["status"].As<std::string>());
+        }
+
+        // Списания в ledger и новые строки payments
+        std::vector<Ledger::Entry> debits;
+        std::vector<int> new_order_ids;
+        std::vector<int> new_user_ids;
+        std::vector<double> new_amounts;
+        std::vector<std::string> new_statuses;
+
+        std::vector<int> outbox_ids;
+        outbox_ids.reserve(batch.size());
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            const auto& payment = batch[i].payment;
+            outbox_ids.push_back(payment.outbox_id);
+
+            const auto it = settled.find(payment.order_id);
+            if (it != settled.end()) {
+                statuses[i] = it->second;
+                continue;
+            }
+
+            auto& balance = balances[payment.user_id];
+            statuses[i] = Decide(payment.outcome, balance, payment.amount);
+            if (statuses[i] == "PAID") {
+                debits.push_back({payment.user_id, -payment.amount, Ledger::kPayment, payment.order_id});
+            }
+
+            // Тот же заказ дальше в пачке получит уже принятое решение
+            settled.emplace(payment.order_id, statuses[i]);
+            new_order_ids.push_back(payment.order_id);
+            new_user_ids.push_back(payment.user_id);
+            new_amounts.push_back(payment.amount);
+            new_statuses.push_back(statuses[i]);
+        }
+
+        versions = ledger_.Append(transaction, debits);
+
+        if (!new_order_ids.empty()) {
+            transaction.Execute(
+                "INSERT INTO payments (order_id, user_id, amount, status) "
+                "SELECT p.order_id, p.user_id, p.amount::numeric, p.status "
+                "FROM UNNEST($1::int[], $2::int[], $3::float8[], $4::text[]) AS p(order_id, user_id, amount, status)",
+                new_order_ids, new_user_ids, new_amounts, new_statuses
+            );
+        }
+
+        // Статус сохраняется в сообщении доставки: если уведомление orderservice не дойдет,
+        // повторная доставка отправит его, не обращаясь к балансу
+        transaction.Execute(
+            "UPDATE outbox o SET delivery = o.delivery || jsonb_build_object('status', d.status) "
+            "FROM UNNEST($1::int[], $2::text[]) AS d(id, status) "
+            "WHERE o.id = d.id",
+            outbox_ids, statuses
+        );
+
+        transaction.Commit();
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to settle batch of " << batch.size() << " payments: " << ex.what();
+        failures_.Add(utils::statistics::Rate{1});
+        for (auto& pending : batch) {
+            pending.promise.set_exception(std::current_exception());
+        }
+        return;
+    }
+
+    for (const auto& [user_id, ledger_id] : versions) {
+        ledger_.WriteThrough(user_id, balances[user_id], ledger_id);
+    }
+
+    batches_.Add(utils::statistics::Rate{1});
+    settled_.Add(utils::statistics::Rate{batch.size()});
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        batch[i].promise.set_value(std::move(statuses[i]));
+    }
+}
+
+yaml_config::Schema Settlement::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Group commit of bank payments
+additionalProperties: false
+properties:
+    max-batch-size:
+        type: integer
+        description: max number of payments settled in one transaction
+        defaultDescription: 256
+    flush-interval:
+        type: string
+        description: how long the first payment of a batch waits for the others
+        defaultDescription: 5ms
+)");
+}
+
+}  // namespace bankservice
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/engine/condition_variable.hpp>
+#include <userver/engine/future.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <Ledger.hpp>
+#include <PaymentSimulator.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace bankservice {
+
+// Групповое проведение платежей. Доставки outbox-worker складывают платежи в общую очередь,
+// фоновая задача забирает их пачкой (до max-batch-size или раз в flush-interval) и проводит
+// одной транзакцией: одна блокировка и одно чтение баланса (Ledger) на каждого пользователя пачки,
+// решение в памяти по текущему остатку, затем списания в ledger, строки payments и статусы в outbox
+// несколькими запросами на всю пачку. Горячий пользователь блокируется один раз на пачку,
+// а не на каждый платеж
+class Settlement final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "settlement";
+
+    struct Payment {
+        // Запись outbox, в delivery которой сохраняется итоговый статус
+        int outbox_id;
+        int order_id;
+        int user_id;
+        double amount;
+        PaymentSimulator::Outcome outcome;
+    };
+
+    Settlement(const components::ComponentConfig& config,
+               const components::ComponentContext& component_context);
+
+    ~Settlement() final;
+
+    // Ставит платеж в очередь и ждет проведения пачки; возвращает статус платежа.
+    // Повтор для уже проведенного заказа возвращает записанный статус
+    std::string Settle(const Payment& payment);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    struct Pending {
+        Payment payment;
+        engine::Promise<std::string> promise;
+    };
+
+    void Run();
+    void Flush(std::vector<Pending>& batch);
+
+    const std::size_t max_batch_size_;
+    const std::chrono::milliseconds flush_interval_;
+
+    storages::postgres::ClusterPtr pg_cluster_;
+    Ledger& ledger_;
+
+    engine::Mutex mutex_;
+    engine::ConditionVariable queue_cv_;
+    std::vector<Pending> queue_;
+
+    utils::statistics::RateCounter batches_;
+    utils::statistics::RateCounter settled_;
+    utils::statistics::RateCounter failures_;
+
+    engine::TaskWithResult<void> flush_task_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace bankservice
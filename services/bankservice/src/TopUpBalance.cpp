@@ -1,9 +1,9 @@
 #include "TopUpBalance.hpp"
 
-#include <userver/storages/postgres/component.hpp>
 #include <userver/server/http/http_status.hpp>
 #include <userver/formats/json.hpp>
 #include <userver/clients/http/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
 
 namespace bankservice {
 
@@ -12,7 +12,8 @@ TopUpBalance::TopUpBalance(
     const userver::components::ComponentContext& component_context
 )
     : HttpHandlerBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      auth_url_(config["auth-url"].As<std::string>("http://authservice:8080/verify/")),
+      ledger_(component_context.FindComponent<Ledger>()),
       http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
 
 std::string TopUpBalance::HandleRequestThrow(
@@ -28,7 +29,7 @@ std::string TopUpBalance::HandleRequestThrow(
     try {
         auto response = http_client_.CreateRequest()
             .get()
-            .url("http://authservice:8080/verify/")
+            .url(auth_url_)
             .headers({{"Authorization", auth_header}})
             .timeout(std::chrono::seconds(2))
             .perform();
@@ -53,14 +54,7 @@ std::string TopUpBalance::HandleRequestThrow(
             return "";
         }
 
-        pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            "INSERT INTO users (user_id, balance) "
-            "VALUES ($1, $2) "
-            "ON CONFLICT (user_id) "
-            "DO UPDATE SET balance = users.balance + $2",
-            user_id, amount
-        );
+        ledger_.TopUp(user_id, amount);
 
         request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
         return "";
@@ -72,5 +66,18 @@ std::string TopUpBalance::HandleRequestThrow(
     }
 }
 
+userver::yaml_config::Schema TopUpBalance::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Tops up the balance of the authorized user
+additionalProperties: false
+properties:
+    auth-url:
+        type: string
+        description: authservice handler that verifies the Authorization header
+        defaultDescription: http://authservice:8080/verify/
+)");
+}
+
 }  // namespace bankservice
 
@@ -10,7 +10,13 @@
 
 #include <userver/utils/daemon_run.hpp>
 
+#include <outbox/Archiver.hpp>
+#include <partitioning/Maintenance.hpp>
+
+#include <Ledger.hpp>
 #include <Payment.hpp>
+#include <PaymentSimulator.hpp>
+#include <Settlement.hpp>
 #include <OutboxWorker.hpp>
 #include <GetBalance.hpp>
 #include <TopUpBalance.hpp>
@@ -22,7 +28,12 @@ int main(int argc, char* argv[]) {
                               .Append<userver::components::HttpClient>()
                               .Append<userver::clients::dns::Component>()
                               .Append<bankservice::Payment>()
+                              .Append<bankservice::Ledger>()
+                              .Append<bankservice::PaymentSimulator>()
+                              .Append<bankservice::Settlement>()
                               .Append<bankservice::OutboxWorker>()
+                              .Append<outbox::Archiver>()
+                              .Append<partitioning::Maintenance>()
                               .Append<bankservice::GetBalance>()
                               .Append<bankservice::TopUpBalance>()
                               .Append<userver::components::Postgres>("postgres-db-1")
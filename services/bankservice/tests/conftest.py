@@ -7,6 +7,29 @@ pytest_plugins = [
     "pytest_userver.plugins.postgresql",
 ]
 
+USERVER_CONFIG_HOOKS = ["userver_config_bankservice"]
+
+
+@pytest.fixture(scope="session")
+def userver_config_bankservice(mockserver_info):
+    """authservice и orderservice - на mockserver, платежи проходят сразу"""
+
+    def do_patch(config_yaml, config_vars):
+        components = config_yaml["components_manager"]["components"]
+        auth_url = mockserver_info.url("authservice/verify/")
+        components["handler-get-balance"]["auth-url"] = auth_url
+        components["handler-top-up-balance"]["auth-url"] = auth_url
+        components["outbox-worker"]["delivery-url"] = mockserver_info.url(
+            "orderservice/payment-result"
+        )
+        components["payment-simulator"]["profile"] = "instant"
+        # Повторная доставка не ждет обычного опроса outbox раз в 10 с
+        components["dynamic-config"]["defaults"][
+            "BANKSERVICE_OUTBOX_POLL_INTERVAL_MS"
+        ] = 100
+
+    return do_patch
+
 
 @pytest.fixture(scope="session")
 def initial_data_path(service_source_dir):
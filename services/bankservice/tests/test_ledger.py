@@ -0,0 +1,168 @@
+# Start the tests via `make test-debug` or `make test-release`
+#
+# authservice и orderservice подменены mockserver (conftest.py), профиль симулятора - instant:
+# платеж проходит сразу, если хватает денег. Кэш балансов Ledger и недавние ключи Payment
+# живут в сервисе между тестами, а база очищается, поэтому у каждого теста свои
+# пользователь и номера заказов
+
+import pytest
+
+from testsuite.databases import pgsql  # noqa: F401
+
+
+@pytest.fixture(name="mock_auth")
+def _mock_auth(mockserver):
+    # Токен в тестах - номер пользователя
+    @mockserver.json_handler("/authservice/verify/")
+    def handler(request):
+        return {"user_id": int(request.headers["Authorization"].split()[-1])}
+
+    return handler
+
+
+@pytest.fixture(name="payment_results")
+def _payment_results(mockserver):
+    # Первые fail_first уведомлений orderservice отвечают 500 - доставка повторится
+    state = {"fail_first": 0, "calls": 0}
+
+    @mockserver.handler("/orderservice/payment-result")
+    def handler(request):
+        state["calls"] += 1
+        if state["calls"] <= state["fail_first"]:
+            return mockserver.make_response(status=500)
+        return mockserver.make_response(status=204)
+
+    handler.state = state
+    return handler
+
+
+async def top_up(service_client, user_id, amount):
+    response = await service_client.post(
+        "/top-up-balance",
+        json={"amount": amount},
+        headers={"Authorization": f"Bearer {user_id}"},
+    )
+    assert response.status == 204
+
+
+async def get_balance(service_client, user_id):
+    response = await service_client.get(
+        "/get-balance", headers={"Authorization": f"Bearer {user_id}"}
+    )
+    assert response.status == 200
+    return response.json()["balance"]
+
+
+async def pay(service_client, user_id, order_id, amount, key=None):
+    response = await service_client.post(
+        "/payment",
+        json={"order_id": order_id, "user_id": user_id, "amount": amount},
+        headers={"Idempotency-Key": key} if key else {},
+    )
+    assert response.status == 204
+
+
+async def wait_status(payment_results):
+    call = await payment_results.wait_call()
+    return call["request"].json["status"]
+
+
+def ledger_entries(pgsql, user_id, kind):
+    cursor = pgsql["db_1"].cursor()
+    cursor.execute(
+        "SELECT order_id, amount::float8 FROM bankserviceschema.ledger "
+        "WHERE user_id = %s AND kind = %s ORDER BY id",
+        (user_id, kind),
+    )
+    return cursor.fetchall()
+
+
+async def test_top_up_appends_to_ledger(service_client, pgsql, mock_auth):
+    await top_up(service_client, 101, 100)
+    await top_up(service_client, 101, 50.5)
+
+    assert await get_balance(service_client, 101) == 150.5
+    # Пополнения только дописываются, баланс - сумма записей
+    assert ledger_entries(pgsql, 101, "TOP_UP") == [(None, 100.0), (None, 50.5)]
+
+
+async def test_payment_debits_balance_once(
+    service_client, pgsql, mock_auth, payment_results
+):
+    await top_up(service_client, 102, 100)
+    await pay(service_client, 102, 10201, 30)
+
+    assert await wait_status(payment_results) == "PAID"
+    assert ledger_entries(pgsql, 102, "PAYMENT") == [(10201, -30.0)]
+    assert await get_balance(service_client, 102) == 70.0
+
+
+async def test_insufficient_funds_not_debited(
+    service_client, pgsql, mock_auth, payment_results
+):
+    await top_up(service_client, 103, 10)
+    await pay(service_client, 103, 10301, 30)
+
+    assert await wait_status(payment_results) == "INSUFFICIENT_FUNDS"
+    assert ledger_entries(pgsql, 103, "PAYMENT") == []
+    assert await get_balance(service_client, 103) == 10.0
+
+
+async def test_redelivery_does_not_settle_twice(
+    service_client, pgsql, mock_auth, payment_results
+):
+    payment_results.state["fail_first"] = 1
+
+    await top_up(service_client, 104, 100)
+    await pay(service_client, 104, 10401, 30)
+
+    # Первое уведомление отклонено, повторная доставка отправляет сохраненный статус
+    assert await wait_status(payment_results) == "PAID"
+    assert await wait_status(payment_results) == "PAID"
+
+    assert ledger_entries(pgsql, 104, "PAYMENT") == [(10401, -30.0)]
+    assert await get_balance(service_client, 104) == 70.0
+
+
+async def test_same_order_under_new_key_not_settled_twice(
+    service_client, pgsql, mock_auth, payment_results
+):
+    await top_up(service_client, 105, 100)
+
+    # Второй ключ создает вторую запись outbox, но заказ уже проведен
+    await pay(service_client, 105, 10501, 30, key="first-10501")
+    assert await wait_status(payment_results) == "PAID"
+    await pay(service_client, 105, 10501, 30, key="second-10501")
+    assert await wait_status(payment_results) == "PAID"
+
+    assert ledger_entries(pgsql, 105, "PAYMENT") == [(10501, -30.0)]
+    assert await get_balance(service_client, 105) == 70.0
+
+
+async def test_balance_after_snapshot(
+    service_client, pgsql, mock_auth, payment_results
+):
+    # Пользователь, которого сервис еще не видел: баланс = снимок + записи после него
+    cursor = pgsql["db_1"].cursor()
+    cursor.execute(
+        "INSERT INTO bankserviceschema.ledger (user_id, amount, kind) "
+        "VALUES (106, 100, 'OPENING'), (106, 50, 'TOP_UP')"
+    )
+    cursor.execute(
+        "INSERT INTO bankserviceschema.balance_snapshots (user_id, balance, ledger_id) "
+        "SELECT 106, SUM(amount), MAX(id) FROM bankserviceschema.ledger WHERE user_id = 106"
+    )
+    cursor.execute(
+        "INSERT INTO bankserviceschema.ledger (user_id, amount, kind) "
+        "VALUES (106, 25, 'TOP_UP')"
+    )
+
+    assert await get_balance(service_client, 106) == 175.0
+
+    # Пополнение и оплата после снимка досчитываются к нему
+    await top_up(service_client, 106, 5)
+    await pay(service_client, 106, 10601, 80)
+    assert await wait_status(payment_results) == "PAID"
+
+    assert await get_balance(service_client, 106) == 100.0
+    assert ledger_entries(pgsql, 106, "PAYMENT") == [(10601, -80.0)]
@@ -0,0 +1,9 @@
+\connect fzon
+
+-- Заказы, товары которых уже убраны из корзины при асинхронном оформлении.
+-- Повторный запрос /remove-ordered-items с тем же order_id ничего не меняет
+CREATE TABLE IF NOT EXISTS cartserviceschema.checked_out_orders (
+    order_id INTEGER PRIMARY KEY,
+    user_id INTEGER NOT NULL,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT now()
+);
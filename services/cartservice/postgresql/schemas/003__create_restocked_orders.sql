@@ -0,0 +1,9 @@
+\connect fzon
+
+-- Заказы, товары которых уже возвращены в корзину после неудачной оплаты.
+-- Повторный запрос /restock-order с тем же order_id ничего не меняет
+CREATE TABLE IF NOT EXISTS cartserviceschema.restocked_orders (
+    order_id INTEGER PRIMARY KEY,
+    user_id INTEGER NOT NULL,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT now()
+);
@@ -0,0 +1,130 @@
+#include "CheckoutCart.hpp"
+
+#include <unordered_map>
+
+#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/clients/http/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+namespace cartservice {
+
+CheckoutCart::CheckoutCart(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()),
+      internal_token_(config["internal-token"].As<std::string>("")) {}
+
+std::string CheckoutCart::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&) const {
+
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        return R"({"error": "Forbidden"})";
+    }
+
+    try {
+        const auto request_json = userver::formats::json::FromString(request.RequestBody());
+
+        if (!request_json.HasMember("userId")) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "";
+        }
+
+        const auto user_id = request_json["userId"].As<int>();
+
+        auto cart_result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT article, quantity FROM cart WHERE user_id = $1",
+            user_id
+        );
+
+        // Пустая корзина и товары без цены - окончательный отказ, orderservice не повторяет запрос
+        if (cart_result.Size() == 0) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kConflict);
+            return R"({"error": "Cart is empty"})";
+        }
+
+        userver::formats::json::ValueBuilder catalog_request;
+        userver::formats::json::ValueBuilder articles_json;
+
+        for (const auto& row : cart_result) {
+            articles_json.PushBack(row["article"].As<std::string>());
+        }
+        catalog_request["articles"] = articles_json;
+
+        auto catalog_response = http_client_.CreateRequest()
+            .post()
+            .url("http://catalogservice:8080/fetch-prices-bulk")
+            .data(userver::formats::json::ToString(catalog_request.ExtractValue()))
+            .timeout(std::chrono::seconds(3))
+            .perform();
+
+        if (catalog_response->status_code() != 200) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kFailedDependency);
+            return R"({"error": "Failed to fetch prices from catalogservice"})";
+        }
+
+        const auto catalog_json = userver::formats::json::FromString(catalog_response->body());
+        std::unordered_map<std::string, double> price_map;
+        std::unordered_map<std::string, std::string> seller_map;
+        for (const auto& price_entry : catalog_json["prices"]) {
+            const auto article = price_entry["article"].As<std::string>();
+            price_map[article] = price_entry["price"].As<double>();
+            seller_map[article] = price_entry["sellerName"].As<std::string>("");
+        }
+
+        // Формат элементов совпадает с cart_items заказа в orderservice
+        userver::formats::json::ValueBuilder cart_items = userver::formats::json::MakeArray();
+
+        for (const auto& row : cart_result) {
+            const auto article = row["article"].As<std::string>();
+            const auto price = price_map.find(article);
+
+            if (price == price_map.end()) {
+                request.SetResponseStatus(userver::server::http::HttpStatus::kConflict);
+                return R"({"error": "Some articles missing prices"})";
+            }
+
+            userver::formats::json::ValueBuilder item;
+            item["article"] = article;
+            item["quantity"] = row["quantity"].As<int>();
+            item["price"] = price->second;
+            item["seller_name"] = seller_map[article];
+            cart_items.PushBack(std::move(item));
+        }
+
+        userver::formats::json::ValueBuilder response_json;
+        response_json["cartItems"] = cart_items;
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response_json.ExtractValue());
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while reading cart for checkout: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return "";
+    }
+}
+
+userver::yaml_config::Schema CheckoutCart::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Cart with current prices for checkout in orderservice
+additionalProperties: false
+properties:
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace cartservice
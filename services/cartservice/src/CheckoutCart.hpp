@@ -0,0 +1,32 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/yaml_config/schema.hpp>
+#include <userver/clients/http/client.hpp>
+
+#include <string>
+
+namespace cartservice {
+
+// Корзина пользователя с актуальными ценами для асинхронного оформления заказа в orderservice
+// Только для orderservice: nginx ручку не проксирует, без X-Internal-Token с internal-token - 403
+class CheckoutCart final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-checkout-cart";
+
+    CheckoutCart(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    userver::clients::http::Client& http_client_;
+    const std::string internal_token_;
+};
+
+}  // namespace cartservice
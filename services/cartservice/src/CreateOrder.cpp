@@ -83,9 +83,11 @@ std::string CreateOrder::
 
         const auto catalog_json = userver::formats::json::FromString(catalog_response->body());
         std::unordered_map<std::string, double> price_map;
+        std::unordered_map<std::string, std::string> seller_map;
         for (const auto& price_entry : catalog_json["prices"]) {
-            price_map[price_entry["article"].As<std::string>()] =
-                price_entry["price"].As<double>();
+            const auto article = price_entry["article"].As<std::string>();
+            price_map[article] = price_entry["price"].As<double>();
+            seller_map[article] = price_entry["sellerName"].As<std::string>("");
         }
 
         // Формируем JSON корзины с ценами
@@ -108,6 +110,9 @@ std::string CreateOrder::
                 return R"({"error": "Some articles missing prices"})";
             }
 
+            // Продавец нужен orderservice для агрегатов продаж по продавцам
+            item["seller_name"] = seller_map[article];
+
             cart_items.PushBack(std::move(item));
             articles_to_remove.push_back({article, quantity});
         }
@@ -129,6 +134,11 @@ std::string CreateOrder::
         if (order_response->status_code() != 204) {
             request.SetResponseStatus(
                 static_cast<userver::server::http::HttpStatus>(order_response->status_code()));
+            // При перегрузке orderservice отвечает 429 и подсказывает, когда повторить
+            const auto& headers = order_response->headers();
+            if (const auto retry_after = headers.find("Retry-After"); retry_after != headers.end()) {
+                request.GetHttpResponse().SetHeader(std::string{"Retry-After"}, retry_after->second);
+            }
             return order_response->body();
         }
 
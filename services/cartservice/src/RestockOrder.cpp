@@ -0,0 +1,98 @@
+#include "RestockOrder.hpp"
+
+#include <string>
+#include <vector>
+
+#include <userver/storages/postgres/component.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+namespace cartservice {
+
+RestockOrder::RestockOrder(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      internal_token_(config["internal-token"].As<std::string>("")) {}
+
+std::string RestockOrder::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&) const {
+
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        return R"({"error": "Forbidden"})";
+    }
+
+    try {
+        const auto request_json = userver::formats::json::FromString(request.RequestBody());
+
+        if (!request_json.HasMember("userId") || !request_json.HasMember("orderId") || !request_json.HasMember("items")) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "";
+        }
+
+        const auto user_id = request_json["userId"].As<int>();
+        const auto order_id = request_json["orderId"].As<int>();
+
+        std::vector<std::string> articles;
+        std::vector<int> quantities;
+        for (const auto& item : request_json["items"]) {
+            articles.push_back(item["article"].As<std::string>());
+            quantities.push_back(item["quantity"].As<int>());
+        }
+
+        auto transaction = pg_cluster_->Begin(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            userver::storages::postgres::TransactionOptions{}
+        );
+
+        // Отметка заказа и возврат товаров в одной транзакции: повтор запроса ничего не добавит
+        auto marked = transaction.Execute(
+            "INSERT INTO restocked_orders (order_id, user_id) VALUES ($1, $2) "
+            "ON CONFLICT (order_id) DO NOTHING RETURNING order_id",
+            order_id, user_id
+        );
+
+        if (marked.Size() > 0) {
+            transaction.Execute(
+                "INSERT INTO cart (user_id, article, quantity) "
+                "SELECT $1, t.article, SUM(t.quantity) "
+                "FROM UNNEST($2::text[], $3::int[]) AS t(article, quantity) "
+                "GROUP BY t.article HAVING SUM(t.quantity) > 0 "
+                "ON CONFLICT (user_id, article) DO UPDATE SET quantity = cart.quantity + EXCLUDED.quantity",
+                user_id, articles, quantities
+            );
+        }
+
+        transaction.Commit();
+
+        request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
+        return "";
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while restocking order: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return "";
+    }
+}
+
+userver::yaml_config::Schema RestockOrder::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Returns items of an unpaid order to the cart once per order_id
+additionalProperties: false
+properties:
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace cartservice
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/yaml_config/schema.hpp>
+
+#include <string>
+
+namespace cartservice {
+
+// Возвращает в корзину все товары неоплаченного заказа одной транзакцией, один раз на order_id
+// Только для orderservice: nginx ручку не проксирует, без X-Internal-Token с internal-token - 403
+class RestockOrder final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-restock-order";
+
+    RestockOrder(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::string internal_token_;
+};
+
+}  // namespace cartservice
@@ -16,6 +16,9 @@
 #include <OrderData.hpp>
 #include <CreateOrder.hpp>
 #include <ChangeCartProductCountByUserId.hpp>
+#include <CheckoutCart.hpp>
+#include <RemoveOrderedItems.hpp>
+#include <RestockOrder.hpp>
 
 int main(int argc, char* argv[]) {
     auto component_list = userver::components::MinimalServerComponentList()
@@ -29,6 +32,9 @@ int main(int argc, char* argv[]) {
                               .Append<cartservice::OrderData>()
                               .Append<cartservice::CreateOrder>()
                               .Append<cartservice::ChangeCartProductCountByUserId>()
+                              .Append<cartservice::CheckoutCart>()
+                              .Append<cartservice::RemoveOrderedItems>()
+                              .Append<cartservice::RestockOrder>()
                               .Append<userver::components::Postgres>("postgres-db-1")
         ;
 
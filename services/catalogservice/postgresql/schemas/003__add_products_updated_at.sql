@@ -0,0 +1,8 @@
+\connect fzon
+
+-- Время последнего изменения товара, по нему product-cache забирает инкрементальные обновления
+ALTER TABLE catalogserviceschema.products
+    ADD COLUMN IF NOT EXISTS updated_at TIMESTAMPTZ NOT NULL DEFAULT now();
+
+CREATE INDEX IF NOT EXISTS products_updated_at_idx
+    ON catalogserviceschema.products (updated_at);
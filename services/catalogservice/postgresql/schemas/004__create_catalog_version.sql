@@ -0,0 +1,10 @@
+\connect fzon
+
+-- Версия каталога, увеличивается при каждом массовом изменении цен
+CREATE TABLE IF NOT EXISTS catalogserviceschema.catalog_version (
+    id BOOLEAN PRIMARY KEY DEFAULT true CHECK (id),
+    version BIGINT NOT NULL DEFAULT 0
+);
+
+INSERT INTO catalogserviceschema.catalog_version (id, version) VALUES (true, 0)
+ON CONFLICT (id) DO NOTHING;
@@ -11,7 +11,8 @@ AddProduct::AddProduct(
     const userver::components::ComponentContext& component_context
 )
     : HttpHandlerBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()) {}
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      product_lookup_(component_context.FindComponent<ProductLookup>()) {}
 
 std::string AddProduct::
     HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
@@ -51,10 +52,14 @@ std::string AddProduct::
         auto result = pg_cluster_->Execute(
             userver::storages::postgres::ClusterHostType::kMaster,
             "INSERT INTO products (article, name, price, description, seller_name, rating) "
-            "VALUES (LPAD((NEXTVAL('product_article_seq'))::text, 4, '0'), $1, $2, $3, $4, $5)",
+            "VALUES (LPAD((NEXTVAL('product_article_seq'))::text, 4, '0'), $1, $2, $3, $4, $5) "
+            "RETURNING article",
             name, price, description, seller_name, rating
         );
 
+        // Новый товар сразу виден в ответах этого инстанса, даже если его артикул уже искали
+        product_lookup_.ApplyNewProduct(result.AsSingleRow<std::string>());
+
         // Успешный ответ - 204 OK без тела
         request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
         return "";
@@ -5,6 +5,8 @@
 
 #include <userver/storages/postgres/cluster.hpp>
 
+#include <ProductLookup.hpp>
+
 namespace catalogservice {
 
 class AddProduct final : public userver::server::handlers::HttpHandlerBase {
@@ -18,6 +20,7 @@ public:
 
 private:
     userver::storages::postgres::ClusterPtr pg_cluster_;
+    ProductLookup& product_lookup_;
 };
 
 }  // namespace catalogservice
@@ -2,7 +2,6 @@
 
 #include <utility>
 
-#include <userver/storages/postgres/component.hpp>
 #include <userver/formats/json.hpp>
 #include <userver/server/http/http_status.hpp>
 #include <userver/clients/http/component.hpp>
@@ -10,12 +9,19 @@
 
 namespace catalogservice {
 
+namespace {
+
+// Через сколько секунд повторять запрос, когда все слоты на поход в БД заняты
+constexpr int kOverloadedRetryAfterSeconds = 1;
+
+}  // namespace
+
 FetchPricesBulk::FetchPricesBulk(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& component_context
 )
     : HttpHandlerBase(config, component_context),
-      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      product_lookup_(component_context.FindComponent<ProductLookup>()),
       http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
 
 std::string FetchPricesBulk::
@@ -34,23 +40,18 @@ std::string FetchPricesBulk::
             return userver::formats::json::ToString(response.ExtractValue());
         }
 
-        // Запрашиваем цены товаров
-        auto result = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kMaster,
-            "SELECT article, price::float8 FROM products WHERE article = ANY($1)",
-            articles
-        );
+        // По этим ценам cartservice собирает заказ, поэтому читаем их из мастера: кэш товаров
+        // на каждой реплике свой и может отставать от цен, записанных через другой инстанс
+        const auto products = product_lookup_.FindManyCurrent(articles);
 
         // Формируем ответ
         userver::formats::json::ValueBuilder prices_builder;
         
-        for (const auto& row : result) {
-            const auto article = row["article"].As<std::string>();
-            const auto price = row["price"].As<double>();
-            
+        for (const auto& product : products) {
             userver::formats::json::ValueBuilder item;
-            item["article"] = article;
-            item["price"] = price;
+            item["article"] = product.article;
+            item["price"] = product.price;
+            item["sellerName"] = product.seller_name;
             
             prices_builder.PushBack(std::move(item));
         }
@@ -61,6 +62,11 @@ std::string FetchPricesBulk::
         request.GetHttpResponse().SetContentType("application/json");
         return userver::formats::json::ToString(response_builder.ExtractValue());
 
+    } catch (const ProductLookupOverloaded& ex) {
+        LOG_WARNING() << "Product lookup overloaded: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kServiceUnavailable);
+        request.GetHttpResponse().SetHeader(std::string{"Retry-After"}, std::to_string(kOverloadedRetryAfterSeconds));
+        return "{\"error\": \"Service overloaded\"}";
     } catch (const std::exception& ex) {
         LOG_ERROR() << "Error while fetching prices: " << ex.what();
         request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
@@ -3,7 +3,8 @@
 #include <userver/components/component.hpp>
 #include <userver/server/handlers/http_handler_base.hpp>
 #include <userver/clients/http/client.hpp>
-#include <userver/storages/postgres/cluster.hpp>
+
+#include <ProductLookup.hpp>
 
 namespace catalogservice {
 
@@ -17,7 +18,7 @@ public:
         const override;
 
 private:
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    ProductLookup& product_lookup_;
     userver::clients::http::Client& http_client_;
 };
 
@@ -0,0 +1,45 @@
+#include <FetchProduct.hpp>
+
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+
+namespace catalogservice {
+
+FetchProduct::FetchProduct(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      product_lookup_(component_context.FindComponent<ProductLookup>()) {}
+
+std::string FetchProduct::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    try {
+        const auto& article = request.GetPathArg("article");
+        if (article.empty()) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "{\"error\": \"Article is required\"}";
+        }
+
+        const auto product = product_lookup_.Find(article);
+        if (!product) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kNotFound);
+            return "{\"error\": \"Product not found\"}";
+        }
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(userver::formats::json::ValueBuilder(*product).ExtractValue());
+
+    } catch (const ProductLookupOverloaded& ex) {
+        LOG_WARNING() << "Product lookup overloaded: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kServiceUnavailable);
+        return "{\"error\": \"Service overloaded\"}";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while fetching product: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return "{\"error\": \"Internal server error\"}";
+    }
+}
+
+}  // namespace catalogservice
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <ProductLookup.hpp>
+
+namespace catalogservice {
+
+class FetchProduct final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-fetch-product";
+
+    FetchProduct(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+private:
+    ProductLookup& product_lookup_;
+};
+
+}  // namespace catalogservice
@@ -6,6 +6,9 @@
 #include <userver/clients/http/component.hpp>
 #include <userver/formats/serialize/common_containers.hpp>
 
+#include <algorithm>
+#include <numeric>
+
 namespace catalogservice {
 
 FetchProductsBulk::FetchProductsBulk(
@@ -67,10 +70,54 @@ std::string FetchProductsBulk::
             }
         }
 
-        // Формируем ответ
+        // Популярность товаров из рейтинга продаж orderservice (sort=popular)
+        std::unordered_map<std::string, std::int64_t> popularity;
+        const bool sort_by_popularity = request.GetArg("sort") == "popular";
+
+        if (sort_by_popularity) {
+            try {
+                const auto window = request.GetArg("window") == "recent" ? "recent" : "all";
+
+                auto ranking_response = http_client_.CreateRequest()
+                    .get()
+                    .url("http://orderservice:8080/best-sellers?window=" + std::string{window} +
+                         "&limit=" + std::to_string(articles.size()))
+                    .timeout(std::chrono::seconds(2))
+                    .perform();
+
+                if (ranking_response->status_code() == 200) {
+                    const auto ranking_json = userver::formats::json::FromString(ranking_response->body());
+                    for (const auto& item : ranking_json["articles"]) {
+                        popularity[item["article"].As<std::string>()] = item["units"].As<std::int64_t>();
+                    }
+                }
+            } catch (const std::exception& ex) {
+                LOG_ERROR() << "Error while requesting best sellers: " << ex.what();
+                // Продолжаем выполнение без сортировки по популярности
+            }
+        }
+
+        const auto get_popularity = [&popularity](const std::string& article) -> std::int64_t {
+            const auto it = popularity.find(article);
+            return it != popularity.end() ? it->second : 0;
+        };
+
+        // Порядок строк в ответе: по убыванию популярности, если она запрошена
+        std::vector<std::size_t> order(result.Size());
+        std::iota(order.begin(), order.end(), 0);
+        if (sort_by_popularity) {
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+                return get_popularity(articles[lhs]) > get_popularity(articles[rhs]);
+            });
+        }
+
+        // Формируем ответ. Порядок ключей JSON-объекта клиенты не обязаны сохранять,
+        // поэтому порядок показа передаем отдельным списком артикулов order
         userver::formats::json::ValueBuilder products_builder;
+        userver::formats::json::ValueBuilder order_builder = userver::formats::json::MakeArray();
 
-        for (const auto& row : result) {
+        for (const auto index : order) {
+            const auto row = result[index];
             const auto article = row["article"].As<std::string>();
             const auto quantity_it = cart_quantities.find(article);
             const auto quantity = (quantity_it != cart_quantities.end()) ? quantity_it->second : 0;
@@ -81,12 +128,17 @@ std::string FetchProductsBulk::
             product_builder["name"] = row["name"].As<std::string>();
             product_builder["rating"] = (row["rating"].As<double>());
             product_builder["productQuantity"] = quantity;
+            if (sort_by_popularity) {
+                product_builder["popularity"] = get_popularity(article);
+            }
 
             products_builder[article] = product_builder;
+            order_builder.PushBack(article);
         }
 
         userver::formats::json::ValueBuilder response_builder;
         response_builder["products"] = products_builder;
+        response_builder["order"] = order_builder;
 
         request.GetHttpResponse().SetContentType("application/json");
         return userver::formats::json::ToString(response_builder.ExtractValue());
@@ -0,0 +1,67 @@
+#include <FetchProductsByArticles.hpp>
+
+#include <userver/formats/json.hpp>
+#include <userver/formats/serialize/common_containers.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+namespace catalogservice {
+
+FetchProductsByArticles::FetchProductsByArticles(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      product_lookup_(component_context.FindComponent<ProductLookup>()),
+      max_articles_(config["max-articles"].As<std::size_t>(100)) {}
+
+std::string FetchProductsByArticles::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    try {
+        // Парсим тело запроса
+        const auto request_json = userver::formats::json::FromString(request.RequestBody());
+        const auto articles = request_json["articles"].As<std::vector<std::string>>();
+
+        if (articles.size() > max_articles_) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "{\"field\": \"articles\", \"error\": \"Too many articles\"}";
+        }
+
+        // Все артикулы разом: промахи мимо кэшей добираются из БД одним запросом
+        const auto products = product_lookup_.FindMany(articles);
+
+        userver::formats::json::ValueBuilder response_builder;
+        response_builder["products"] = products;
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response_builder.ExtractValue());
+
+    } catch (const userver::formats::json::Exception& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return "{\"error\": \"Invalid request body\"}";
+    } catch (const ProductLookupOverloaded& ex) {
+        LOG_WARNING() << "Product lookup overloaded: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kServiceUnavailable);
+        return "{\"error\": \"Service overloaded\"}";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while fetching products by articles: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return "{\"error\": \"Internal server error\"}";
+    }
+}
+
+userver::yaml_config::Schema FetchProductsByArticles::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Batched product lookup by articles
+additionalProperties: false
+properties:
+    max-articles:
+        type: integer
+        description: max number of articles in one request
+        defaultDescription: 100
+)");
+}
+
+}  // namespace catalogservice
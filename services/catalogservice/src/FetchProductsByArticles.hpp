@@ -0,0 +1,26 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <ProductLookup.hpp>
+
+namespace catalogservice {
+
+class FetchProductsByArticles final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-fetch-products-by-articles";
+
+    FetchProductsByArticles(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    ProductLookup& product_lookup_;
+    const std::size_t max_articles_;
+};
+
+}  // namespace catalogservice
@@ -0,0 +1,19 @@
+#include <ProductCache.hpp>
+
+#include <userver/formats/json/value_builder.hpp>
+
+namespace catalogservice {
+
+userver::formats::json::Value
+Serialize(const Product& product, userver::formats::serialize::To<userver::formats::json::Value>) {
+    userver::formats::json::ValueBuilder builder;
+    builder["article"] = product.article;
+    builder["name"] = product.name;
+    builder["price"] = product.price;
+    builder["description"] = product.description;
+    builder["sellerName"] = product.seller_name;
+    builder["rating"] = product.rating;
+    return builder.ExtractValue();
+}
+
+}  // namespace catalogservice
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <userver/cache/base_postgres_cache.hpp>
+#include <userver/dump/aggregates.hpp>
+#include <userver/dump/common_containers.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/formats/serialize/to.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+
+namespace catalogservice {
+
+// Полная карточка товара
+struct Product {
+    std::string article;
+    std::string name;
+    double price{0.0};
+    std::string description;
+    std::string seller_name;
+    double rating{0.0};
+};
+
+userver::formats::json::Value
+Serialize(const Product& product, userver::formats::serialize::To<userver::formats::json::Value>);
+
+// Все товары каталога в памяти по артикулу. Раз в update-interval подтягиваем
+// только изменившиеся строки (по updated_at), раз в full-update-interval - весь каталог.
+// Содержимое периодически сбрасывается в дамп на диск: после рестарта кэш поднимается из дампа
+// и догоняет БД инкрементальным обновлением вместо чтения всей таблицы
+struct ProductCachePolicy {
+    static constexpr std::string_view kName = "product-cache";
+
+    using ValueType = Product;
+    static constexpr auto kKeyMember = &Product::article;
+
+    static constexpr const char* kQuery =
+        "SELECT article, name, price::float8, description, seller_name, rating::float8 "
+        "FROM catalogserviceschema.products";
+    static constexpr const char* kUpdatedField = "updated_at";
+    using UpdatedFieldType = userver::storages::postgres::TimePointTz;
+};
+
+using ProductCache = userver::components::PostgreCache<ProductCachePolicy>;
+
+}  // namespace catalogservice
+
+// Product - агрегат, для дампа пишем и читаем его поля по порядку.
+// При изменении набора полей нужно увеличить dump.format-version у product-cache
+template <>
+struct userver::dump::IsDumpedAggregate<catalogservice::Product>;
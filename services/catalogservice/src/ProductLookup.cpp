@@ -0,0 +1,258 @@
+#include "ProductLookup.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <unordered_map>
+#include <utility>
+
+namespace catalogservice {
+
+namespace {
+
+constexpr std::size_t kCacheWays = 16;
+
+}  // namespace
+
+ProductLookup::ProductLookup(const components::ComponentConfig& config,
+                             const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      product_cache_(component_context.FindComponent<ProductCache>()),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      hot_cache_(kCacheWays, config["hot-cache-size"].As<std::size_t>(4096) / kCacheWays + 1),
+      admission_counters_(kCacheWays, config["hot-cache-size"].As<std::size_t>(4096) / kCacheWays + 1),
+      admission_threshold_(config["admission-threshold"].As<std::uint32_t>(2)),
+      db_fallback_semaphore_(config["db-fallback-concurrency"].As<std::size_t>(8)),
+      db_fallback_wait_(config["db-fallback-wait"].As<std::chrono::milliseconds>(std::chrono::milliseconds{200})),
+      price_override_ttl_(config["price-override-ttl"].As<std::chrono::milliseconds>(std::chrono::seconds{5}))
+{
+    hot_cache_.SetMaxLifetime(config["hot-cache-ttl"].As<std::chrono::milliseconds>(std::chrono::seconds{5}));
+    admission_counters_.SetMaxLifetime(
+        config["admission-window"].As<std::chrono::milliseconds>(std::chrono::seconds{10})
+    );
+}
+
+std::optional<Product> ProductLookup::Find(const std::string& article) {
+    auto products = FindMany({article});
+    if (products.empty()) {
+        return std::nullopt;
+    }
+    return std::move(products.front());
+}
+
+std::vector<Product> ProductLookup::FindMany(const std::vector<std::string>& articles) {
+    const auto snapshot = product_cache_.Get();
+
+    std::unordered_map<std::string, Product> found;
+    std::vector<std::string> misses;
+
+    for (const auto& article : articles) {
+        if (found.count(article) > 0) {
+            continue;
+        }
+
+        if (const auto it = snapshot->find(article); it != snapshot->end()) {
+            found.emplace(article, it->second);
+            continue;
+        }
+
+        if (auto cached = hot_cache_.GetOptionalNoUpdate(article)) {
+            if (*cached) {
+                found.emplace(article, std::move(**cached));
+            }
+            continue;
+        }
+
+        misses.push_back(article);
+    }
+
+    if (!misses.empty()) {
+        // Товара нет в снапшоте - либо он появился после последнего обновления кэша, либо его нет вовсе
+        auto fetched = FetchFromDb(misses, userver::storages::postgres::ClusterHostType::kSlave);
+
+        std::unordered_map<std::string, Product> fetched_by_article;
+        for (auto& product : fetched) {
+            auto article = product.article;
+            fetched_by_article.emplace(std::move(article), std::move(product));
+        }
+
+        std::vector<std::string> not_found;
+        for (const auto& article : misses) {
+            if (fetched_by_article.count(article) == 0) {
+                not_found.push_back(article);
+            }
+        }
+        if (!not_found.empty()) {
+            for (auto& product : FetchFromDb(not_found, userver::storages::postgres::ClusterHostType::kMaster)) {
+                auto article = product.article;
+                fetched_by_article.emplace(std::move(article), std::move(product));
+            }
+        }
+
+        for (const auto& article : misses) {
+            const auto it = fetched_by_article.find(article);
+            std::optional<Product> product;
+            if (it != fetched_by_article.end()) {
+                product = it->second;
+                found.emplace(article, it->second);
+            }
+
+            if (Admit(article)) {
+                hot_cache_.Put(article, std::move(product));
+            }
+        }
+    }
+
+    std::vector<Product> result;
+    result.reserve(found.size());
+    for (const auto& article : articles) {
+        auto it = found.find(article);
+        if (it != found.end()) {
+            result.push_back(std::move(it->second));
+            found.erase(it);
+        }
+    }
+
+    ApplyPriceOverrides(result);
+    return result;
+}
+
+std::vector<Product> ProductLookup::FindManyCurrent(const std::vector<std::string>& articles) {
+    auto fetched = FetchFromDb(articles, userver::storages::postgres::ClusterHostType::kMaster);
+
+    std::unordered_map<std::string, Product> found;
+    for (auto& product : fetched) {
+        auto article = product.article;
+        found.emplace(std::move(article), std::move(product));
+    }
+
+    std::vector<Product> result;
+    result.reserve(found.size());
+    for (const auto& article : articles) {
+        auto it = found.find(article);
+        if (it != found.end()) {
+            result.push_back(std::move(it->second));
+            found.erase(it);
+        }
+    }
+    return result;
+}
+
+void ProductLookup::ApplyPriceUpdates(const std::vector<std::pair<std::string, double>>& prices) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto expires_at = now + price_override_ttl_;
+    const auto snapshot = product_cache_.Get();
+
+    {
+        auto overrides = price_overrides_.StartWrite();
+        for (auto it = overrides->begin(); it != overrides->end();) {
+            it = it->second.expires_at <= now ? overrides->erase(it) : std::next(it);
+        }
+        for (const auto& [article, price] : prices) {
+            // Товара нет в снапшоте или цена там уже новая - переопределять нечего
+            const auto it = snapshot->find(article);
+            if (it == snapshot->end() || it->second.price == price) {
+                overrides->erase(article);
+                continue;
+            }
+            (*overrides)[article] = PriceOverride{price, it->second.price, expires_at};
+        }
+        overrides.Commit();
+    }
+
+    // Товары из горячего кэша перечитаем из БД уже с новой ценой
+    for (const auto& [article, price] : prices) {
+        hot_cache_.InvalidateByKey(article);
+    }
+
+    product_cache_.InvalidateAsync(cache::UpdateType::kIncremental);
+}
+
+void ProductLookup::ApplyNewProduct(const std::string& article) {
+    // Артикул могли запросить до вставки (например, угадав следующий номер), и в горячем кэше
+    // лежит "нет такого товара". На других инстансах запись доживет до своего TTL
+    hot_cache_.InvalidateByKey(article);
+    product_cache_.InvalidateAsync(cache::UpdateType::kIncremental);
+}
+
+void ProductLookup::ApplyPriceOverrides(std::vector<Product>& products) const {
+    const auto overrides = price_overrides_.Read();
+    if (overrides->empty()) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto& product : products) {
+        const auto it = overrides->find(product.article);
+        if (it != overrides->end() && it->second.expires_at > now && product.price == it->second.replaced_price) {
+            product.price = it->second.price;
+        }
+    }
+}
+
+std::vector<Product> ProductLookup::FetchFromDb(const std::vector<std::string>& articles,
+                                                userver::storages::postgres::ClusterHostType host_type) {
+    engine::SemaphoreLock lock(db_fallback_semaphore_, db_fallback_wait_);
+    if (!lock.OwnsLock()) {
+        throw ProductLookupOverloaded("Too many concurrent product lookups in database");
+    }
+
+    auto result = pg_cluster_->Execute(
+        host_type,
+        "SELECT article, name, price::float8, description, seller_name, rating::float8 "
+        "FROM catalogserviceschema.products WHERE article = ANY($1)",
+        articles
+    );
+
+    return result.AsContainer<std::vector<Product>>(userver::storages::postgres::kRowTag);
+}
+
+bool ProductLookup::Admit(const std::string& article) {
+    const auto misses = admission_counters_.GetOptionalNoUpdate(article).value_or(0) + 1;
+    if (misses >= admission_threshold_) {
+        admission_counters_.InvalidateByKey(article);
+        return true;
+    }
+
+    admission_counters_.Put(article, misses);
+    return false;
+}
+
+yaml_config::Schema ProductLookup::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Product lookup with admission-controlled hot-item cache
+additionalProperties: false
+properties:
+    hot-cache-size:
+        type: integer
+        description: max number of articles kept in hot cache
+        defaultDescription: 4096
+    hot-cache-ttl:
+        type: string
+        description: how long a product fetched from database stays in hot cache
+        defaultDescription: 5s
+    admission-threshold:
+        type: integer
+        description: number of database misses within admission-window before an article is admitted to hot cache
+        defaultDescription: 2
+    admission-window:
+        type: string
+        description: time window for admission miss counters
+        defaultDescription: 10s
+    db-fallback-concurrency:
+        type: integer
+        description: max number of concurrent database fallback queries
+        defaultDescription: 8
+    db-fallback-wait:
+        type: string
+        description: how long to wait for a free database fallback slot before giving up
+        defaultDescription: 200ms
+    price-override-ttl:
+        type: string
+        description: how long updated prices are applied on top of product-cache, should exceed its update interval
+        defaultDescription: 5s
+)");
+}
+
+}  // namespace catalogservice
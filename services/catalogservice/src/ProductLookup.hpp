@@ -0,0 +1,98 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/cache/expirable_lru_cache.hpp>
+#include <userver/engine/semaphore.hpp>
+#include <userver/rcu/rcu.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ProductCache.hpp>
+
+namespace catalogservice {
+
+// Бросается, когда все слоты на поход в БД заняты дольше db-fallback-wait
+class ProductLookupOverloaded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Поиск товаров по артикулу.
+// Сначала смотрим в product-cache, затем в горячий LRU-кэш, и только потом идем в БД.
+// В горячий кэш товар попадает после admission-threshold промахов за admission-window,
+// так что единичные запросы его не вымывают, а вирусный товар перестает доходить до БД.
+// Отсутствующие товары тоже кэшируются, чтобы запросы несуществующих артикулов не били в БД.
+// Промах читается с реплики, а отсутствие перед кэшированием подтверждается на мастере:
+// иначе отстающая реплика закрыла бы только что добавленный товар на hot-cache-ttl.
+// Новые цены после UpdatePrices накладываются поверх снапшота на price-override-ttl,
+// пока product-cache не подтянет их инкрементальным обновлением. Переопределение действует,
+// только пока в снапшоте лежит цена, которую оно заменило: любая более новая цена из кэша
+// (в том числе записанная через другой инстанс) его отменяет.
+// Цены для списания денег берутся через FindManyCurrent, в обход кэшей.
+class ProductLookup final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "product-lookup";
+
+    ProductLookup(const components::ComponentConfig& config,
+                  const components::ComponentContext& component_context);
+
+    std::optional<Product> Find(const std::string& article);
+
+    // Порядок результата совпадает с порядком articles, неизвестные артикулы пропускаются
+    std::vector<Product> FindMany(const std::vector<std::string>& articles);
+
+    // То же, но прямо из мастера, без кэшей и переопределений цен: цены, по которым списываются деньги.
+    // Запросы ограничены теми же слотами, что и поход в БД при промахе
+    std::vector<Product> FindManyCurrent(const std::vector<std::string>& articles);
+
+    // Применяет уже записанные в БД цены: новые значения сразу видны в ответах
+    void ApplyPriceUpdates(const std::vector<std::pair<std::string, double>>& prices);
+
+    // Товар только что записан в БД: сбрасывает закэшированное отсутствие артикула
+    void ApplyNewProduct(const std::string& article);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    using HotCache = cache::ExpirableLruCache<std::string, std::optional<Product>>;
+    using AdmissionCounters = cache::ExpirableLruCache<std::string, std::uint32_t>;
+
+    struct PriceOverride {
+        double price{0.0};
+        // Цена в снапшоте на момент обновления; когда снапшот меняет ее, переопределение больше не нужно
+        double replaced_price{0.0};
+        std::chrono::steady_clock::time_point expires_at;
+    };
+    using PriceOverrides = std::unordered_map<std::string, PriceOverride>;
+
+    std::vector<Product> FetchFromDb(const std::vector<std::string>& articles,
+                                     userver::storages::postgres::ClusterHostType host_type);
+    bool Admit(const std::string& article);
+    void ApplyPriceOverrides(std::vector<Product>& products) const;
+
+    ProductCache& product_cache_;
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    HotCache hot_cache_;
+    AdmissionCounters admission_counters_;
+    const std::uint32_t admission_threshold_;
+
+    engine::Semaphore db_fallback_semaphore_;
+    const std::chrono::milliseconds db_fallback_wait_;
+
+    rcu::Variable<PriceOverrides> price_overrides_;
+    const std::chrono::milliseconds price_override_ttl_;
+};
+
+}  // namespace catalogservice
@@ -0,0 +1,131 @@
+#include <UpdatePrices.hpp>
+
+#include <utility>
+
+#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+namespace catalogservice {
+
+UpdatePrices::UpdatePrices(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      product_lookup_(component_context.FindComponent<ProductLookup>()),
+      max_prices_(config["max-prices"].As<std::size_t>(10000)),
+      internal_token_(config["internal-token"].As<std::string>("")) {}
+
+std::string UpdatePrices::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        return "{\"error\": \"Forbidden\"}";
+    }
+
+    try {
+        // Парсим тело запроса: {"prices": [{"article": "0001", "price": 8990.0}, ...]}
+        const auto request_json = userver::formats::json::FromString(request.RequestBody());
+        const auto prices_json = request_json["prices"];
+
+        if (!prices_json.IsArray() || prices_json.GetSize() == 0) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "{\"field\": \"prices\", \"error\": \"Missing required fields\"}";
+        }
+        if (prices_json.GetSize() > max_prices_) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+            return "{\"field\": \"prices\", \"error\": \"Too many prices\"}";
+        }
+
+        std::vector<std::string> articles;
+        std::vector<double> prices;
+        articles.reserve(prices_json.GetSize());
+        prices.reserve(prices_json.GetSize());
+
+        for (const auto& item : prices_json) {
+            const auto price = item["price"].As<double>();
+            if (price <= 0) {
+                request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+                return "{\"field\": \"price\", \"error\": \"Price must be positive\"}";
+            }
+
+            articles.push_back(item["article"].As<std::string>());
+            prices.push_back(price);
+        }
+
+        // Все цены одним UPDATE и увеличение версии каталога в той же транзакции.
+        // DISTINCT ON оставляет последнюю цену, если артикул пришел несколько раз
+        auto transaction = pg_cluster_->Begin(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            userver::storages::postgres::TransactionOptions{}
+        );
+
+        auto updated = transaction.Execute(
+            "UPDATE catalogserviceschema.products AS p "
+            "SET price = u.price::numeric(10, 2), updated_at = now() "
+            "FROM ("
+            "    SELECT DISTINCT ON (article) article, price "
+            "    FROM UNNEST($1::text[], $2::float8[]) WITH ORDINALITY AS t(article, price, ord) "
+            "    ORDER BY article, ord DESC"
+            ") AS u "
+            "WHERE p.article = u.article "
+            "RETURNING p.article, p.price::float8",
+            articles, prices
+        );
+
+        const auto version = transaction.Execute(
+            "UPDATE catalogserviceschema.catalog_version SET version = version + 1 RETURNING version"
+        ).AsSingleRow<std::int64_t>();
+
+        transaction.Commit();
+
+        std::vector<std::pair<std::string, double>> applied;
+        applied.reserve(updated.Size());
+        for (const auto& row : updated) {
+            applied.emplace_back(row["article"].As<std::string>(), row["price"].As<double>());
+        }
+
+        // Новые цены сразу видны в ответах этого инстанса, не дожидаясь обновления кэша
+        product_lookup_.ApplyPriceUpdates(applied);
+
+        userver::formats::json::ValueBuilder response_builder;
+        response_builder["updated"] = applied.size();
+        response_builder["catalogVersion"] = version;
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response_builder.ExtractValue());
+
+    } catch (const userver::formats::json::Exception& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return "{\"error\": \"Invalid request body\"}";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while updating prices: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return "{\"error\": \"Internal server error\"}";
+    }
+}
+
+userver::yaml_config::Schema UpdatePrices::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Bulk price update
+additionalProperties: false
+properties:
+    max-prices:
+        type: integer
+        description: max number of (article, price) pairs in one request
+        defaultDescription: 10000
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace catalogservice
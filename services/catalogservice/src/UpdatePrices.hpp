@@ -0,0 +1,33 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <string>
+
+#include <ProductLookup.hpp>
+
+namespace catalogservice {
+
+// Массовое обновление цен: make update-prices PRICES=<файл>.
+// Только внутри сети: nginx ручку не проксирует, без X-Internal-Token с internal-token - 403
+class UpdatePrices final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-update-prices";
+
+    UpdatePrices(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    ProductLookup& product_lookup_;
+    const std::size_t max_prices_;
+    const std::string internal_token_;
+};
+
+}  // namespace catalogservice
@@ -2,6 +2,7 @@
 #include <userver/clients/http/component.hpp>
 #include <userver/components/component.hpp>
 #include <userver/components/component_list.hpp>
+#include <userver/components/dump_configurator.hpp>
 #include <userver/components/minimal_server_component_list.hpp>
 #include <userver/server/handlers/ping.hpp>
 #include <userver/testsuite/testsuite_support.hpp>
@@ -13,6 +14,11 @@
 #include <AddProduct.hpp>
 #include <FetchProductsBulk.hpp>
 #include <FetchPricesBulk.hpp>
+#include <ProductCache.hpp>
+#include <ProductLookup.hpp>
+#include <FetchProduct.hpp>
+#include <FetchProductsByArticles.hpp>
+#include <UpdatePrices.hpp>
 
 int main(int argc, char* argv[]) {
     auto component_list = userver::components::MinimalServerComponentList()
@@ -20,9 +26,15 @@ int main(int argc, char* argv[]) {
                               .Append<userver::components::TestsuiteSupport>()
                               .Append<userver::components::HttpClient>()
                               .Append<userver::clients::dns::Component>()
+                              .Append<userver::components::DumpConfigurator>()
                               .Append<catalogservice::AddProduct>()
                               .Append<catalogservice::FetchProductsBulk>()
                               .Append<catalogservice::FetchPricesBulk>()
+                              .Append<catalogservice::ProductCache>()
+                              .Append<catalogservice::ProductLookup>()
+                              .Append<catalogservice::FetchProduct>()
+                              .Append<catalogservice::FetchProductsByArticles>()
+                              .Append<catalogservice::UpdatePrices>()
                               .Append<userver::components::Postgres>("postgres-db-1")
         ;
 
@@ -0,0 +1,95 @@
+# Start the tests via `make test-debug` or `make test-release`
+#
+# В testsuite product-cache обновляется только при сбросе кэшей перед тестом, поэтому
+# товары, вставленные прямо в БД после первого запроса, видны только через ProductLookup:
+# горячий кэш и поход в БД. В static_config admission-threshold: 2
+
+import pytest
+
+from testsuite.databases import pgsql  # noqa: F401
+
+MISSING_ARTICLE = "9000001"
+
+
+def insert_product(pgsql, article, price):
+    pgsql["db_1"].cursor().execute(
+        "INSERT INTO catalogserviceschema.products "
+        "(article, name, price, description, seller_name, rating) "
+        "VALUES (%s, 'Тестовый товар', %s, 'Описание', 'TestSeller', 4.5)",
+        (article, price),
+    )
+
+
+def update_price(pgsql, article, price):
+    pgsql["db_1"].cursor().execute(
+        "UPDATE catalogserviceschema.products SET price = %s WHERE article = %s",
+        (price, article),
+    )
+
+
+async def test_product_from_snapshot(service_client):
+    response = await service_client.get("/product/0001")
+    assert response.status == 200
+    assert response.json()["article"] == "0001"
+    assert response.json()["price"] == 8990.0
+
+
+async def test_single_miss_not_cached(service_client, pgsql):
+    # Первый промах не проходит admission: следующий запрос снова идет в БД
+    response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+    assert response.status == 404
+
+    insert_product(pgsql, MISSING_ARTICLE, 100)
+
+    response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+    assert response.status == 200
+    assert response.json()["price"] == 100.0
+
+
+async def test_missing_article_cached_after_admission(service_client, pgsql):
+    for _ in range(2):
+        response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+        assert response.status == 404
+
+    insert_product(pgsql, MISSING_ARTICLE, 100)
+
+    # "Нет товара" уже в горячем кэше, в БД не ходим
+    response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+    assert response.status == 404
+
+
+async def test_hot_product_served_from_cache(service_client, pgsql):
+    await service_client.get("/ping")
+    insert_product(pgsql, MISSING_ARTICLE, 100)
+
+    for _ in range(2):
+        response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+        assert response.status == 200
+        assert response.json()["price"] == 100.0
+
+    update_price(pgsql, MISSING_ARTICLE, 200)
+
+    # Товар прошел admission и отдается из горячего кэша до hot-cache-ttl
+    response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+    assert response.status == 200
+    assert response.json()["price"] == 100.0
+
+
+@pytest.mark.parametrize("requests_before", [1, 2])
+async def test_multi_get_shares_hot_cache(service_client, pgsql, requests_before):
+    await service_client.get("/ping")
+    insert_product(pgsql, MISSING_ARTICLE, 100)
+
+    for _ in range(requests_before):
+        response = await service_client.post(
+            "/fetch-products-by-articles",
+            json={"articles": ["0001", MISSING_ARTICLE]},
+        )
+        assert response.status == 200
+
+    update_price(pgsql, MISSING_ARTICLE, 200)
+
+    response = await service_client.get(f"/product/{MISSING_ARTICLE}")
+    assert response.status == 200
+    # После двух промахов товар в горячем кэше, после одного - еще читается из БД
+    assert response.json()["price"] == (100.0 if requests_before == 2 else 200.0)
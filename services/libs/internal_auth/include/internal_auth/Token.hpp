@@ -0,0 +1,17 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/server/http/http_request.hpp>
+
+#include <string_view>
+
+namespace internal_auth {
+
+// Заголовок с внутренним токеном (INTERNAL_TOKEN из .env)
+inline constexpr std::string_view kHeader = "X-Internal-Token";
+
+// true, если в запросе передан ожидаемый токен. Сравнение за постоянное время;
+// пустой ожидаемый токен (не задан в окружении) не пропускает ни один запрос
+bool IsInternalRequest(const server::http::HttpRequest& request, std::string_view token);
+
+}  // namespace internal_auth
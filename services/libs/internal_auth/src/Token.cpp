@@ -0,0 +1,22 @@
+#include <internal_auth/Token.hpp>
+
+namespace internal_auth {
+
+bool IsInternalRequest(const server::http::HttpRequest& request, std::string_view token) {
+    if (token.empty()) {
+        return false;
+    }
+
+    const auto& provided = request.GetHeader(kHeader);
+    if (provided.size() != token.size()) {
+        return false;
+    }
+
+    unsigned char diff = 0;
+    for (std::size_t i = 0; i < token.size(); ++i) {
+        diff |= static_cast<unsigned char>(provided[i]) ^ static_cast<unsigned char>(token[i]);
+    }
+    return diff == 0;
+}
+
+}  // namespace internal_auth
@@ -0,0 +1,42 @@
+#include "BenchmarkHandler.hpp"
+
+#include <userver/engine/sleep.hpp>
+#include <userver/formats/json.hpp>
+
+#include <stdexcept>
+
+namespace outbox {
+
+namespace {
+
+const dynamic_config::Key<std::int64_t> kBenchBatchSize{"OUTBOX_BENCH_BATCH_SIZE", 100};
+const dynamic_config::Key<std::int64_t> kBenchPollIntervalMs{"OUTBOX_BENCH_POLL_INTERVAL_MS", 1000};
+
+}  // namespace
+
+DynamicConfigKeys BenchmarkHandler::ConfigKeys() {
+    return {kBenchBatchSize, kBenchPollIntervalMs};
+}
+
+BenchmarkHandler::BenchmarkHandler(const components::ComponentConfig&,
+                                   const components::ComponentContext&) {}
+
+std::optional<formats::json::Value> BenchmarkHandler::Process(storages::postgres::Transaction&,
+                                                              const Record& record) {
+    if (!record.payload.HasMember("delivery_ms")) {
+        return std::nullopt;
+    }
+    return record.payload;
+}
+
+void BenchmarkHandler::Deliver(const Record& record, const formats::json::Value& message) {
+    engine::InterruptibleSleepFor(std::chrono::milliseconds{message["delivery_ms"].As<std::int64_t>()});
+
+    if (record.attempts == 0 && record.id % 100 < message["failure_percent"].As<int>(0)) {
+        throw std::runtime_error("simulated delivery failure");
+    }
+}
+
+void BenchmarkHandler::OnCommitted(const std::vector<Record>&) {}
+
+}  // namespace outbox
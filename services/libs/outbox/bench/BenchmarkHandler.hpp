@@ -0,0 +1,32 @@
+#pragma once
+
+#include <outbox/Consumer.hpp>
+
+namespace outbox {
+
+// Обработчик для нагрузочного прогона (make bench-outbox) на отдельной таблице outbox_bench.
+// Собирается только в бинарник fzon-outbox-bench, в сервисы не входит.
+// Process ничего не пишет в БД. Если в payload есть delivery_ms, запись проходит доставку:
+// пауза delivery_ms, а записи с id % 100 < failure_percent падают на первой попытке и уходят на повтор
+class BenchmarkHandler final {
+public:
+    static constexpr std::string_view kName = "outbox-bench-consumer";
+    static constexpr std::string_view kTable = "outbox_bench";
+    static constexpr std::string_view kNotifyChannel = "outbox_bench";
+
+    static DynamicConfigKeys ConfigKeys();
+
+    BenchmarkHandler(const components::ComponentConfig& config,
+                     const components::ComponentContext& component_context);
+
+    std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                const Record& record);
+
+    void Deliver(const Record& record, const formats::json::Value& message);
+
+    void OnCommitted(const std::vector<Record>& records);
+};
+
+using BenchmarkConsumer = Consumer<BenchmarkHandler>;
+
+}  // namespace outbox
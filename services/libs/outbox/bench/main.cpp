@@ -0,0 +1,23 @@
+#include <userver/clients/dns/component.hpp>
+#include <userver/components/minimal_server_component_list.hpp>
+#include <userver/server/handlers/ping.hpp>
+#include <userver/testsuite/testsuite_support.hpp>
+
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/utils/daemon_run.hpp>
+
+#include "BenchmarkHandler.hpp"
+
+// Бинарник только с консьюмером outbox_bench, запускается из run-outbox-bench
+int main(int argc, char* argv[]) {
+    auto component_list = userver::components::MinimalServerComponentList()
+                              .Append<userver::server::handlers::Ping>()
+                              .Append<userver::components::TestsuiteSupport>()
+                              .Append<userver::clients::dns::Component>()
+                              .Append<outbox::BenchmarkConsumer>()
+                              .Append<userver::components::Postgres>("postgres-db-1")
+        ;
+
+    return userver::utils::DaemonMain(argc, argv, component_list);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace outbox {
+
+// Удаляет обработанные (DONE) записи таблицы table старше retention небольшими пачками
+// и публикует метрики очереди: размер backlog, возраст самой старой записи, готовой к обработке,
+// и количество записей в DEAD
+class Archiver final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "outbox-archiver";
+
+    Archiver(const components::ComponentConfig& config,
+             const components::ComponentContext& component_context);
+
+    ~Archiver() final;
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+    // Последние снятые значения backlog, обновляются раз в period
+    std::int64_t GetPendingCount() const { return pending_count_.load(); }
+    double GetOldestPendingAgeSeconds() const { return oldest_pending_age_seconds_.load(); }
+
+private:
+    void DoWork();
+    void RefreshBacklog();
+    void Archive();
+
+    const std::string table_;
+    const std::chrono::milliseconds retention_;
+    const std::int64_t batch_size_;
+    const std::size_t max_batches_;
+
+    std::atomic<std::int64_t> pending_count_{0};
+    std::atomic<double> oldest_pending_age_seconds_{0.0};
+    std::atomic<std::int64_t> dead_count_{0};
+    std::atomic<std::uint64_t> archived_total_{0};
+
+    utils::PeriodicTask periodic_task_;
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace outbox
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <outbox/ConsumerBase.hpp>
+
+namespace outbox {
+
+// Outbox-консьюмер с обработчиком записей Handler. Handler должен объявить:
+//   static constexpr std::string_view kName;           имя компонента
+//   static constexpr std::string_view kTable;          таблица outbox (в search_path сервиса)
+//   static constexpr std::string_view kNotifyChannel;  канал pg_notify, в который пишут продюсеры
+//   static DynamicConfigKeys ConfigKeys();
+//   Handler(const components::ComponentConfig&, const components::ComponentContext&);
+//   std::optional<formats::json::Value> Process(storages::postgres::Transaction&, const Record&);
+//   void Deliver(const Record&, const formats::json::Value& message);
+//   void OnCommitted(const std::vector<Record>&);
+// Смысл методов описан в ConsumerBase
+template <typename Handler>
+class Consumer final : public ConsumerBase {
+public:
+    static constexpr std::string_view kName = Handler::kName;
+    // Продюсеры отправляют pg_notify в этот канал вместе со вставкой записи
+    static constexpr std::string_view kNotifyChannel = Handler::kNotifyChannel;
+
+    Consumer(const components::ComponentConfig& config,
+             const components::ComponentContext& component_context)
+        : ConsumerBase(config, component_context, Handler::kTable, Handler::kNotifyChannel, Handler::ConfigKeys()),
+          handler_(config, component_context)
+    {
+        Start();
+    }
+
+    ~Consumer() final {
+        // Консьюмеры обращаются к handler_, останавливаем их до его уничтожения
+        Stop();
+    }
+
+    static yaml_config::Schema GetStaticConfigSchema() {
+        return ConsumerBase::GetStaticConfigSchema();
+    }
+
+private:
+    std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                const Record& record) final {
+        return handler_.Process(transaction, record);
+    }
+
+    void Deliver(const Record& record, const formats::json::Value& message) final {
+        handler_.Deliver(record, message);
+    }
+
+    void OnCommitted(const std::vector<Record>& records) final {
+        handler_.OnCommitted(records);
+    }
+
+    Handler handler_;
+};
+
+}  // namespace outbox
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/concurrent/background_task_storage.hpp>
+#include <userver/dynamic_config/source.hpp>
+#include <userver/dynamic_config/value.hpp>
+#include <userver/engine/semaphore.hpp>
+#include <userver/engine/task/task_processor_fwd.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/formats/json/value.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/storages/postgres/transaction.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace outbox {
+
+// Запись outbox в том виде, в котором ее получает обработчик
+struct Record {
+    int id;
+    int user_id;
+    formats::json::Value payload;
+    // Сколько попыток обработки и доставки уже было
+    int attempts;
+};
+
+// Ключи динамического конфига, которые сервис объявляет под своими именами
+struct DynamicConfigKeys {
+    const dynamic_config::Key<std::int64_t>& batch_size;
+    const dynamic_config::Key<std::int64_t>& poll_interval_ms;
+};
+
+// Общая часть outbox-консьюмера, не зависящая от типа обработчика.
+//
+// Жизненный цикл записи (колонка status):
+//   PENDING  -> Process в транзакции пачки под своим savepoint
+//   DELIVERY -> Deliver вне транзакции, параллельно, не больше max-parallel-deliveries
+//               на инстанс. Консьюмер не ждет доставок и идет к следующим шардам, пока
+//               есть свободные слоты; от повторной выборки запись скрыта арендой
+//   DONE     -> обработана, удаляется outbox::Archiver
+//   DEAD     -> исчерпаны max-attempts, остается для разбора
+// Неудачная попытка откладывает запись с экспоненциальной задержкой.
+//
+// Записи разбиты на shard-count шардов по user_id, шард в каждый момент разбирает
+// один консьюмер во всех репликах (advisory lock), поэтому записи пользователя
+// проходят Process в порядке вставки. Доставка - at-least-once, порядок доставок не гарантируется.
+class ConsumerBase : public components::ComponentBase {
+public:
+    static yaml_config::Schema GetStaticConfigSchema();
+
+protected:
+    ConsumerBase(const components::ComponentConfig& config,
+                 const components::ComponentContext& component_context,
+                 std::string_view table,
+                 std::string_view notify_channel,
+                 DynamicConfigKeys config_keys);
+
+    ~ConsumerBase() override;
+
+    // Запускают и останавливают консьюмеров. Вызываются наследником,
+    // когда обработчик уже создан и пока он еще не уничтожен
+    void Start();
+    void Stop() noexcept;
+
+    // Выполняется в транзакции пачки; возвращает сообщение, которое нужно доставить после коммита
+    virtual std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                        const Record& record) = 0;
+
+    // Доставка сообщения вне транзакции; исключение означает неудачную попытку
+    virtual void Deliver(const Record& record, const formats::json::Value& message) = 0;
+
+    // Вызывается после коммита пачки для записей, успешно прошедших Process
+    virtual void OnCommitted(const std::vector<Record>& records) = 0;
+
+private:
+    struct Delivery {
+        Record record;
+        formats::json::Value message;
+    };
+
+    void Run(std::size_t consumer);
+    // Возвращает количество выбранных из шарда записей, 0 - если шард занят другим консьюмером
+    std::size_t DoWork(std::size_t shard, std::size_t batch_size);
+    // Запускает доставки в фоне; ждет только свободного слота max-parallel-deliveries
+    void StartDeliveries(std::vector<Delivery>&& deliveries);
+    void DeliverOne(const Delivery& delivery);
+    std::chrono::milliseconds Backoff(int attempts) const;
+
+    const std::string table_;
+    const std::string notify_channel_;
+    const DynamicConfigKeys config_keys_;
+    const std::size_t consumers_;
+    const std::size_t shard_count_;
+    const int max_attempts_;
+    const std::chrono::milliseconds base_backoff_;
+    const std::chrono::milliseconds max_backoff_;
+    const std::chrono::milliseconds delivery_lease_;
+
+    // Запросы собираются один раз под имя таблицы
+    const std::string select_query_;
+    const std::string mark_done_query_;
+    const std::string mark_delivery_query_;
+    const std::string lease_query_;
+    const std::string retry_query_;
+
+    dynamic_config::Source config_source_;
+    storages::postgres::ClusterPtr pg_cluster_;
+    engine::TaskProcessor& delivery_task_processor_;
+    engine::Semaphore delivery_semaphore_;
+
+    utils::statistics::RateCounter processed_;
+    utils::statistics::RateCounter delivered_;
+    utils::statistics::RateCounter process_failures_;
+    utils::statistics::RateCounter delivery_failures_;
+    utils::statistics::RateCounter dead_lettered_;
+    // Возраст самой старой записи последней пачки, мс
+    std::atomic<std::int64_t> lag_ms_{0};
+
+    std::vector<engine::TaskWithResult<void>> worker_tasks_;
+    // Доставки в работе; останавливаются в Stop вместе с консьюмерами
+    concurrent::BackgroundTaskStorage delivery_tasks_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace outbox
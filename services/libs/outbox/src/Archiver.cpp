@@ -0,0 +1,128 @@
+#include <outbox/Archiver.hpp>
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <optional>
+
+namespace outbox {
+
+Archiver::Archiver(const components::ComponentConfig& config,
+                   const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      table_(config["table"].As<std::string>("outbox")),
+      retention_(config["retention"].As<std::chrono::milliseconds>(std::chrono::hours{1})),
+      batch_size_(config["batch-size"].As<std::int64_t>(1000)),
+      max_batches_(config["max-batches"].As<std::size_t>(10)),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster())
+{
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter(
+        "outbox",
+        [this](utils::statistics::Writer& writer) {
+            writer["pending"] = pending_count_.load();
+            writer["oldest-pending-age-seconds"] = oldest_pending_age_seconds_.load();
+            writer["dead"] = dead_count_.load();
+            writer["archived"] = archived_total_.load();
+        },
+        {{"outbox_table", table_}}
+    );
+
+    utils::PeriodicTask::Settings settings{
+        config["period"].As<std::chrono::milliseconds>(std::chrono::seconds{5})
+    };
+    periodic_task_.Start(table_ + "-archiver-task", settings, [this] { DoWork(); });
+}
+
+Archiver::~Archiver() {
+    periodic_task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+void Archiver::DoWork() {
+    RefreshBacklog();
+    Archive();
+}
+
+void Archiver::RefreshBacklog() {
+    try {
+        // Считается по частичным индексам незавершенных записей; таблица берется из search_path сервиса.
+        // Возраст - только по записям, готовым к обработке: отложенная до next_attempt_at повторная
+        // попытка и запись в доставке не означают, что консьюмеры не успевают
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT COUNT(*) FILTER (WHERE status IN ('PENDING', 'DELIVERY')) AS pending, "
+            "EXTRACT(EPOCH FROM now() - MIN(created_at) "
+            "    FILTER (WHERE status = 'PENDING' AND next_attempt_at <= now()))::float8 AS oldest_age, "
+            "COUNT(*) FILTER (WHERE status = 'DEAD') AS dead "
+            "FROM " + table_ + " WHERE status IN ('PENDING', 'DELIVERY', 'DEAD')"
+        );
+
+        pending_count_ = result[0]["pending"].As<std::int64_t>();
+        oldest_pending_age_seconds_ = result[0]["oldest_age"].As<std::optional<double>>().value_or(0.0);
+        dead_count_ = result[0]["dead"].As<std::int64_t>();
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to refresh " << table_ << " backlog: " << ex.what();
+    }
+}
+
+void Archiver::Archive() {
+    try {
+        for (std::size_t batch = 0; batch < max_batches_; ++batch) {
+            // Маленькие пачки: короткие транзакции и без долгих блокировок для консьюмеров
+            auto result = pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "DELETE FROM " + table_ + " WHERE id IN ("
+                "    SELECT id FROM " + table_ + " "
+                "    WHERE status = 'DONE' AND created_at < now() - $1 * interval '1 millisecond' "
+                "    ORDER BY created_at LIMIT $2 FOR UPDATE SKIP LOCKED"
+                ")",
+                static_cast<std::int64_t>(retention_.count()),
+                batch_size_
+            );
+
+            const auto deleted = result.RowsAffected();
+            archived_total_ += deleted;
+
+            if (deleted < static_cast<std::size_t>(batch_size_)) {
+                break;
+            }
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to archive " << table_ << ": " << ex.what();
+    }
+}
+
+yaml_config::Schema Archiver::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Deletes processed outbox records and reports outbox backlog metrics
+additionalProperties: false
+properties:
+    table:
+        type: string
+        description: outbox table in the service search_path
+        defaultDescription: outbox
+    period:
+        type: string
+        description: how often metrics are refreshed and processed records are archived
+        defaultDescription: 5s
+    retention:
+        type: string
+        description: how long processed records are kept
+        defaultDescription: 1h
+    batch-size:
+        type: integer
+        description: max number of records deleted by one statement
+        defaultDescription: 1000
+    max-batches:
+        type: integer
+        description: max number of delete statements per iteration
+        defaultDescription: 10
+)");
+}
+
+}  // namespace outbox
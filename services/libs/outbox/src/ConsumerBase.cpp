@@ -0,0 +1,414 @@
+#include <outbox/ConsumerBase.hpp>
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/dynamic_config/storage/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/current_task.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/exceptions.hpp>
+#include <userver/utils/async.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace outbox {
+
+namespace {
+
+constexpr std::string_view kStatusDelivery = "DELIVERY";
+constexpr std::string_view kStatusDead = "DEAD";
+
+engine::TaskProcessor& GetDeliveryTaskProcessor(const components::ComponentConfig& config,
+                                                const components::ComponentContext& component_context) {
+    const auto name = config["delivery-task-processor"].As<std::optional<std::string>>();
+    if (!name) {
+        return engine::current_task::GetTaskProcessor();
+    }
+    return component_context.GetTaskProcessor(*name);
+}
+
+}  // namespace
+
+ConsumerBase::ConsumerBase(const components::ComponentConfig& config,
+                           const components::ComponentContext& component_context,
+                           std::string_view table,
+                           std::string_view notify_channel,
+                           DynamicConfigKeys config_keys)
+    : components::ComponentBase(config, component_context),
+      table_(table),
+      notify_channel_(notify_channel),
+      config_keys_(config_keys),
+      consumers_(config["consumers"].As<std::size_t>(2)),
+      shard_count_(config["shard-count"].As<std::size_t>(16)),
+      max_attempts_(config["max-attempts"].As<int>(10)),
+      base_backoff_(config["base-backoff"].As<std::chrono::milliseconds>(std::chrono::seconds{1})),
+      max_backoff_(config["max-backoff"].As<std::chrono::milliseconds>(std::chrono::minutes{5})),
+      delivery_lease_(config["delivery-lease"].As<std::chrono::milliseconds>(std::chrono::minutes{1})),
+      // Шард захватывается advisory lock до конца транзакции. CTE с волатильной функцией
+      // вычисляется один раз, поэтому занятый шард дает пустую выборку за один запрос.
+      // Запись не берется, пока более ранняя запись того же пользователя ждет повтора
+      select_query_(
+          "WITH shard_lock AS ("
+          "    SELECT pg_try_advisory_xact_lock(hashtext($1), $2) AS locked"
+          ") "
+          "SELECT o.id, o.user_id, o.payload, o.status, o.attempts, o.delivery, "
+          "       (EXTRACT(EPOCH FROM now() - o.created_at) * 1000)::bigint AS lag_ms "
+          "FROM " + table_ + " o, shard_lock "
+          "WHERE shard_lock.locked AND o.status IN ('PENDING', 'DELIVERY') "
+          "AND o.next_attempt_at <= now() AND mod(o.user_id, $3) = $2 "
+          "AND (o.status = 'DELIVERY' OR NOT EXISTS ("
+          "    SELECT 1 FROM " + table_ + " p "
+          "    WHERE p.status = 'PENDING' AND p.user_id = o.user_id AND p.id < o.id AND p.next_attempt_at > now()"
+          ")) "
+          "ORDER BY o.id LIMIT $4"
+      ),
+      mark_done_query_(
+          "UPDATE " + table_ + " SET status = 'DONE', last_error = NULL WHERE id = $1"
+      ),
+      // Пока идет доставка, запись скрыта от других консьюмеров на время аренды
+      mark_delivery_query_(
+          "UPDATE " + table_ + " SET status = 'DELIVERY', delivery = $2, "
+          "next_attempt_at = now() + $3 * interval '1 millisecond' WHERE id = $1"
+      ),
+      lease_query_(
+          "UPDATE " + table_ + " SET next_attempt_at = now() + $2 * interval '1 millisecond' "
+          "WHERE id = ANY($1)"
+      ),
+      retry_query_(
+          "UPDATE " + table_ + " SET attempts = attempts + 1, last_error = $2, "
+          "status = CASE WHEN attempts + 1 >= $3 THEN 'DEAD' ELSE status END, "
+          "next_attempt_at = now() + $4 * interval '1 millisecond' "
+          "WHERE id = $1 RETURNING status"
+      ),
+      config_source_(component_context.FindComponent<components::DynamicConfig>().GetSource()),
+      pg_cluster_(component_context.FindComponent<components::Postgres>("postgres-db-1").GetCluster()),
+      delivery_task_processor_(GetDeliveryTaskProcessor(config, component_context)),
+      delivery_semaphore_(config["max-parallel-deliveries"].As<std::size_t>(8)),
+      delivery_tasks_(delivery_task_processor_)
+{
+    if (consumers_ == 0 || shard_count_ == 0) {
+        throw std::runtime_error(std::string{config.Name()} + ": consumers and shard-count must be positive");
+    }
+
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter(
+        "outbox.consumer",
+        [this](utils::statistics::Writer& writer) {
+            writer["processed"] = processed_.Load();
+            writer["delivered"] = delivered_.Load();
+            writer["process-failures"] = process_failures_.Load();
+            writer["delivery-failures"] = delivery_failures_.Load();
+            writer["dead-lettered"] = dead_lettered_.Load();
+            writer["lag-ms"] = lag_ms_.load();
+        },
+        {{"outbox_table", table_}}
+    );
+}
+
+ConsumerBase::~ConsumerBase() {
+    Stop();
+    statistics_holder_.Unregister();
+}
+
+void ConsumerBase::Start() {
+    worker_tasks_.reserve(consumers_);
+    for (std::size_t consumer = 0; consumer < consumers_; ++consumer) {
+        worker_tasks_.push_back(utils::CriticalAsync(
+            table_ + "-consumer-" + std::to_string(consumer),
+            [this, consumer] { Run(consumer); }
+        ));
+    }
+}
+
+void ConsumerBase::Stop() noexcept {
+    for (auto& task : worker_tasks_) {
+        if (task.IsValid()) {
+            task.SyncCancel();
+        }
+    }
+    worker_tasks_.clear();
+    // Прерванные доставки повторятся после истечения аренды
+    delivery_tasks_.CancelAndWait();
+}
+
+void ConsumerBase::Run(std::size_t consumer) {
+    while (!engine::current_task::ShouldCancel()) {
+        // Нулевые и отрицательные значения из динамического конфига поднимаем до 1: пачка из 0 записей
+        // зациклила бы проход по шардам, нулевой интервал - опрос БД без пауз
+        std::chrono::milliseconds poll_interval{
+            std::max<std::int64_t>(config_source_.GetCopy(config_keys_.poll_interval_ms), 1)
+        };
+
+        try {
+            // LISTEN до первого DoWork: уведомления, пришедшие во время обработки, не теряются
+            auto notify_scope = pg_cluster_->Listen(notify_channel_);
+
+            while (!engine::current_task::ShouldCancel()) {
+                const auto snapshot = config_source_.GetSnapshot();
+                const auto batch_size =
+                    static_cast<std::size_t>(std::max<std::int64_t>(snapshot[config_keys_.batch_size], 1));
+                poll_interval = std::chrono::milliseconds{
+                    std::max<std::int64_t>(snapshot[config_keys_.poll_interval_ms], 1)
+                };
+
+                // Обходим все шарды, начиная со "своего", чтобы консьюмеры не толкались на одних и тех же.
+                // Повторяем проход, пока хотя бы один шард отдал полную пачку
+                bool has_more = true;
+                while (has_more && !engine::current_task::ShouldCancel()) {
+                    has_more = false;
+                    for (std::size_t i = 0; i < shard_count_ && !engine::current_task::ShouldCancel(); ++i) {
+                        const auto shard = (consumer + i) % shard_count_;
+                        if (DoWork(shard, batch_size) == batch_size) {
+                            has_more = true;
+                        }
+                    }
+                }
+
+                try {
+                    notify_scope.WaitNotify(engine::Deadline::FromDuration(poll_interval));
+                } catch (const storages::postgres::ConnectionTimeout&) {
+                    // Уведомлений не было - все равно проверяем outbox, там могут быть отложенные повторы
+                }
+            }
+        } catch (const std::exception& ex) {
+            if (engine::current_task::ShouldCancel()) {
+                break;
+            }
+            LOG_ERROR() << "Error in " << table_ << " consumer listen loop: " << ex.what();
+            engine::InterruptibleSleepFor(poll_interval);
+        }
+    }
+}
+
+std::size_t ConsumerBase::DoWork(std::size_t shard, std::size_t batch_size) {
+    std::vector<Delivery> deliveries;
+    std::size_t fetched = 0;
+
+    try {
+        auto transaction = pg_cluster_->Begin(
+            storages::postgres::ClusterHostType::kMaster,
+            storages::postgres::TransactionOptions{}
+        );
+
+        auto result = transaction.Execute(
+            select_query_,
+            notify_channel_,
+            static_cast<int>(shard),
+            static_cast<int>(shard_count_),
+            static_cast<std::int64_t>(batch_size)
+        );
+
+        if (result.Size() == 0) {
+            transaction.Rollback();
+            return 0; // Нет записей для обработки или шард занят
+        }
+
+        fetched = result.Size();
+
+        // Записи, успешно прошедшие Process, для OnCommitted
+        std::vector<Record> committed;
+        // Записи в DELIVERY, доставку которых повторяем: продлеваем им аренду
+        std::vector<int> leased_ids;
+        // Пользователи, у которых запись не обработалась: их следующие записи ждут повтора,
+        // иначе обработка пошла бы не в порядке вставки
+        std::unordered_set<int> failed_users;
+        std::int64_t lag_ms = 0;
+
+        for (const auto& row : result) {
+            lag_ms = std::max(lag_ms, row["lag_ms"].As<std::optional<std::int64_t>>().value_or(0));
+
+            Record record{
+                row["id"].As<int>(),
+                row["user_id"].As<int>(),
+                row["payload"].As<formats::json::Value>(),
+                row["attempts"].As<int>()
+            };
+
+            if (row["status"].As<std::string>() == kStatusDelivery) {
+                leased_ids.push_back(record.id);
+                deliveries.push_back({std::move(record), row["delivery"].As<formats::json::Value>()});
+                continue;
+            }
+
+            if (failed_users.count(record.user_id) > 0) {
+                continue;
+            }
+
+            const auto savepoint = "outbox_record_" + std::to_string(record.id);
+            try {
+                transaction.Execute("SAVEPOINT " + savepoint);
+
+                auto message = Process(transaction, record);
+                if (message) {
+                    transaction.Execute(
+                        mark_delivery_query_,
+                        record.id,
+                        *message,
+                        static_cast<std::int64_t>(delivery_lease_.count())
+                    );
+                    deliveries.push_back({record, std::move(*message)});
+                } else {
+                    transaction.Execute(mark_done_query_, record.id);
+                }
+
+                committed.push_back(std::move(record));
+
+            } catch (const std::exception& ex) {
+                // Откатываем только ЭТУ запись и откладываем ее, продолжаем остальные
+                LOG_ERROR() << "Failed to process " << table_ << " record " << record.id << ": " << ex.what();
+                transaction.Execute("ROLLBACK TO SAVEPOINT " + savepoint);
+                failed_users.insert(record.user_id);
+                process_failures_.Add(utils::statistics::Rate{1});
+
+                const auto retry = transaction.Execute(
+                    retry_query_,
+                    record.id,
+                    std::string{ex.what()},
+                    max_attempts_,
+                    static_cast<std::int64_t>(Backoff(record.attempts + 1).count())
+                );
+                if (retry.Size() > 0 && retry[0]["status"].As<std::string>() == kStatusDead) {
+                    dead_lettered_.Add(utils::statistics::Rate{1});
+                    LOG_ERROR() << "Giving up on " << table_ << " record " << record.id
+                                << " after " << record.attempts + 1 << " attempts";
+                }
+            }
+        }
+
+        if (!leased_ids.empty()) {
+            transaction.Execute(lease_query_, leased_ids, static_cast<std::int64_t>(delivery_lease_.count()));
+        }
+
+        transaction.Commit();
+
+        lag_ms_ = lag_ms;
+        processed_.Add(utils::statistics::Rate{committed.size()});
+        OnCommitted(committed);
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error in " << table_ << " consumer DoWork: " << ex.what();
+        return 0;
+    }
+
+    StartDeliveries(std::move(deliveries));
+    return fetched;
+}
+
+void ConsumerBase::StartDeliveries(std::vector<Delivery>&& deliveries) {
+    // Слот семафора берется до запуска задачи: медленные доставки одного шарда не держат
+    // обход остальных, а консьюмер останавливается, только когда заняты все слоты инстанса
+    for (auto& delivery : deliveries) {
+        engine::SemaphoreLock slot{delivery_semaphore_};
+        delivery_tasks_.AsyncDetach(
+            "outbox-delivery",
+            [this, delivery = std::move(delivery), slot = std::move(slot)] { DeliverOne(delivery); }
+        );
+    }
+}
+
+void ConsumerBase::DeliverOne(const Delivery& delivery) {
+    const auto& record = delivery.record;
+
+    std::string error;
+    try {
+        Deliver(record, delivery.message);
+        // Если отметка не запишется, сообщение будет доставлено повторно после аренды
+        pg_cluster_->Execute(storages::postgres::ClusterHostType::kMaster, mark_done_query_, record.id);
+        delivered_.Add(utils::statistics::Rate{1});
+        return;
+    } catch (const std::exception& ex) {
+        error = ex.what();
+    }
+
+    delivery_failures_.Add(utils::statistics::Rate{1});
+
+    try {
+        const auto retry = pg_cluster_->Execute(
+            storages::postgres::ClusterHostType::kMaster,
+            retry_query_,
+            record.id,
+            error,
+            max_attempts_,
+            static_cast<std::int64_t>(Backoff(record.attempts + 1).count())
+        );
+
+        if (retry.Size() > 0 && retry[0]["status"].As<std::string>() == kStatusDead) {
+            dead_lettered_.Add(utils::statistics::Rate{1});
+            LOG_ERROR() << "Giving up on delivery of " << table_ << " record " << record.id
+                        << " after " << record.attempts + 1 << " attempts: " << error;
+        } else {
+            LOG_WARNING() << "Failed to deliver " << table_ << " record " << record.id
+                          << " (attempt " << record.attempts + 1 << "): " << error;
+        }
+    } catch (const std::exception& ex) {
+        // Запись вернется в работу сама, когда истечет аренда
+        LOG_ERROR() << "Failed to reschedule " << table_ << " record " << record.id << ": " << ex.what();
+    }
+}
+
+std::chrono::milliseconds ConsumerBase::Backoff(int attempts) const {
+    const auto shift = std::clamp(attempts - 1, 0, 20);
+    return std::min(base_backoff_ * (std::int64_t{1} << shift), max_backoff_);
+}
+
+yaml_config::Schema ConsumerBase::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Outbox consumer with per-record savepoints, retries and parallel delivery
+additionalProperties: false
+properties:
+    consumers:
+        type: integer
+        description: number of consumer coroutines in this instance
+        defaultDescription: 2
+    shard-count:
+        type: integer
+        description: number of user_id shards, must be the same in all replicas
+        defaultDescription: 16
+    max-attempts:
+        type: integer
+        description: number of attempts before a record is moved to DEAD
+        defaultDescription: 10
+    base-backoff:
+        type: string
+        description: delay before the first retry, doubled on each next one
+        defaultDescription: 1s
+    max-backoff:
+        type: string
+        description: upper bound for retry delay
+        defaultDescription: 5m
+    delivery-task-processor:
+        type: string
+        description: task processor for deliveries
+        defaultDescription: task processor of the component
+    max-parallel-deliveries:
+        type: integer
+        description: max number of concurrent deliveries in this instance
+        defaultDescription: 8
+    delivery-timeout:
+        type: string
+        description: timeout of one delivery, used by the record handler
+        defaultDescription: 5s
+    delivery-url:
+        type: string
+        description: URL the record handler delivers to
+        defaultDescription: chosen by the record handler
+    delivery-lease:
+        type: string
+        description: how long a record being delivered is hidden from other consumers
+        defaultDescription: 1m
+    internal-token:
+        type: string
+        description: token for internal handlers of other services, used by the record handler
+        defaultDescription: ''
+)");
+}
+
+}  // namespace outbox
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/rcu/rcu.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace partitioning {
+
+// Обслуживает таблицы, секционированные по месяцам created_at (RANGE).
+// Секция таблицы T за месяц YYYYMM называется T_pYYYYMM и лежит в той же схеме (search_path сервиса).
+// Раз в period:
+//   - заранее создает секции на premake-months месяцев вперед; строки этих месяцев, успевшие
+//     попасть в секцию DEFAULT, переносятся в новую секцию;
+//   - публикует, на сколько месяцев вперед есть секции (months-ahead), и пишет LOG_CRITICAL,
+//     если меньше premake-months;
+//   - секции старше detach-after-months отсоединяет и переносит в archive-schema,
+//     где их можно выгрузить или удалить, не трогая горячие данные;
+//   - снимает размеры секций для метрик partitions.
+class Maintenance final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "partition-maintenance";
+
+    Maintenance(const components::ComponentConfig& config,
+                const components::ComponentContext& component_context);
+
+    ~Maintenance() final;
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    struct PartitionSize {
+        std::string table;
+        std::string partition;
+        std::int64_t bytes{0};
+        std::int64_t rows{0};
+    };
+
+    void DoWork();
+    void CreateFuturePartitions(const std::string& table);
+    void CreatePartition(const std::string& table, const std::string& partition,
+                         const std::string& from_date, const std::string& to_date,
+                         const std::string& default_partition);
+    void CheckCoverage(std::size_t index);
+    void DetachOldPartitions(const std::string& table);
+    void RefreshSizes();
+
+    const std::vector<std::string> tables_;
+    const int premake_months_;
+    const int detach_after_months_;
+    const std::string archive_schema_;
+
+    // Месяцев вперед, закрытых секциями, по индексу в tables_; -1 - еще не проверено
+    std::vector<std::atomic<int>> months_ahead_;
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    rcu::Variable<std::vector<PartitionSize>> sizes_;
+
+    utils::PeriodicTask periodic_task_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace partitioning
@@ -0,0 +1,310 @@
+#include <partitioning/Maintenance.hpp>
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/utils/statistics/labels.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <chrono>
+#include <stdexcept>
+
+namespace partitioning {
+
+namespace {
+
+// DDL над секциями ждет блокировку таблицы не дольше этого, а не копит за собой очередь запросов
+const std::string kSetLockTimeout = "SET LOCAL lock_timeout = '5s'";
+
+// Транзакции с DDL и переносом строк из DEFAULT. Ожидание блокировок ограничивает lock_timeout,
+// а statement_timeout по умолчанию (500 мс) отменил бы и LOCK, и перенос раньше него
+const userver::storages::postgres::CommandControl kDdlCommandControl{
+    std::chrono::minutes{10}, std::chrono::minutes{10}
+};
+
+}  // namespace
+
+Maintenance::Maintenance(const components::ComponentConfig& config,
+                         const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      tables_(config["tables"].As<std::vector<std::string>>()),
+      premake_months_(config["premake-months"].As<int>(3)),
+      detach_after_months_(config["detach-after-months"].As<int>(0)),
+      archive_schema_(config["archive-schema"].As<std::string>("")),
+      months_ahead_(tables_.size()),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster())
+{
+    if (detach_after_months_ > 0 && archive_schema_.empty()) {
+        throw std::runtime_error("partition-maintenance: archive-schema is required when detach-after-months is set");
+    }
+    for (auto& months_ahead : months_ahead_) {
+        months_ahead = -1;
+    }
+
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("partitions", [this](utils::statistics::Writer& writer) {
+        const auto sizes = sizes_.Read();
+        for (const auto& size : *sizes) {
+            writer["bytes"].ValueWithLabels(size.bytes, {{"table", size.table}, {"partition", size.partition}});
+            writer["rows"].ValueWithLabels(size.rows, {{"table", size.table}, {"partition", size.partition}});
+        }
+        for (std::size_t i = 0; i < tables_.size(); ++i) {
+            writer["months-ahead"].ValueWithLabels(
+                months_ahead_[i].load(), utils::statistics::LabelView{"table", tables_[i]}
+            );
+        }
+    });
+
+    // Первый проход сразу при старте, чтобы секция текущего месяца точно существовала
+    utils::PeriodicTask::Settings settings{
+        config["period"].As<std::chrono::milliseconds>(std::chrono::hours{1}),
+        utils::PeriodicTask::Flags::kNow
+    };
+    periodic_task_.Start("partition-maintenance-task", settings, [this] { DoWork(); });
+}
+
+Maintenance::~Maintenance() {
+    periodic_task_.Stop();
+    statistics_holder_.Unregister();
+}
+
+void Maintenance::DoWork() {
+    for (std::size_t i = 0; i < tables_.size(); ++i) {
+        CreateFuturePartitions(tables_[i]);
+        CheckCoverage(i);
+        if (detach_after_months_ > 0) {
+            DetachOldPartitions(tables_[i]);
+        }
+    }
+    RefreshSizes();
+}
+
+void Maintenance::CreateFuturePartitions(const std::string& table) {
+    try {
+        // Имена и границы секций считаются в БД, чтобы месяцы совпадали с created_at
+        auto months = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT to_char(m, 'YYYYMM') AS suffix, "
+            "       to_char(m, 'YYYY-MM-DD') AS from_date, "
+            "       to_char(m + interval '1 month', 'YYYY-MM-DD') AS to_date "
+            "FROM generate_series(date_trunc('month', now()), "
+            "                     date_trunc('month', now()) + $1 * interval '1 month', "
+            "                     interval '1 month') AS m "
+            "WHERE to_regclass($2 || '_p' || to_char(m, 'YYYYMM')) IS NULL",
+            premake_months_, table
+        );
+        if (months.IsEmpty()) {
+            return;
+        }
+
+        auto default_res = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT partdefid::regclass::text AS partition "
+            "FROM pg_partitioned_table "
+            "WHERE partrelid = $1::regclass AND partdefid <> 0",
+            table
+        );
+        const auto default_partition = default_res.IsEmpty()
+            ? std::string{}
+            : default_res.Front()["partition"].As<std::string>();
+
+        for (const auto& month : months) {
+            CreatePartition(
+                table,
+                table + "_p" + month["suffix"].As<std::string>(),
+                month["from_date"].As<std::string>(),
+                month["to_date"].As<std::string>(),
+                default_partition
+            );
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to create partitions of " << table << ": " << ex.what();
+    }
+}
+
+void Maintenance::CreatePartition(const std::string& table, const std::string& partition,
+                                  const std::string& from_date, const std::string& to_date,
+                                  const std::string& default_partition) {
+    const auto bounds = " FOR VALUES FROM ('" + from_date + "') TO ('" + to_date + "')";
+
+    if (default_partition.empty()) {
+        pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "CREATE TABLE IF NOT EXISTS " + partition + " PARTITION OF " + table + bounds
+        );
+        return;
+    }
+
+    // При секции по умолчанию новая секция не создается, пока в DEFAULT лежат строки ее месяца.
+    // Строки переносятся в отдельную таблицу, и она присоединяется секцией; DEFAULT заблокирован
+    // на запись до коммита, чтобы туда не успели попасть новые строки этого месяца
+    auto transaction = pg_cluster_->Begin(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        userver::storages::postgres::TransactionOptions{},
+        kDdlCommandControl
+    );
+    transaction.Execute(kSetLockTimeout);
+    transaction.Execute("LOCK TABLE " + default_partition + " IN EXCLUSIVE MODE");
+    transaction.Execute(
+        "CREATE TABLE " + partition + " (LIKE " + table + " INCLUDING DEFAULTS INCLUDING CONSTRAINTS)"
+    );
+    const auto moved = transaction.Execute(
+        "WITH moved AS ("
+        "    DELETE FROM " + default_partition +
+        "    WHERE created_at >= $1::timestamp AND created_at < $2::timestamp "
+        "    RETURNING *"
+        ") "
+        "INSERT INTO " + partition + " SELECT * FROM moved",
+        from_date, to_date
+    );
+    transaction.Execute("ALTER TABLE " + table + " ATTACH PARTITION " + partition + bounds);
+    transaction.Commit();
+
+    if (moved.RowsAffected() > 0) {
+        LOG_WARNING() << "Moved " << moved.RowsAffected() << " rows from " << default_partition
+                      << " into " << partition;
+    }
+}
+
+void Maintenance::CheckCoverage(std::size_t index) {
+    const auto& table = tables_[index];
+    try {
+        // Сколько месяцев после текущего подряд закрыто секциями
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT COALESCE(MIN(i), $2 + 1) - 1 AS months_ahead "
+            "FROM generate_series(0, $2) AS i "
+            "WHERE to_regclass($1 || '_p' || "
+            "                  to_char(date_trunc('month', now()) + i * interval '1 month', 'YYYYMM')) IS NULL",
+            table, premake_months_
+        );
+        const auto months_ahead = result.Front()["months_ahead"].As<int>();
+        months_ahead_[index] = months_ahead;
+
+        // Без секций вставки уходят в DEFAULT (или падают, если ее нет) - это авария, а не шум
+        if (months_ahead < premake_months_) {
+            LOG_CRITICAL() << "Partitions of " << table << " cover only " << months_ahead
+                           << " months ahead, expected " << premake_months_;
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to check partition coverage of " << table << ": " << ex.what();
+    }
+}
+
+void Maintenance::DetachOldPartitions(const std::string& table) {
+    try {
+        // Секции, вся месячная граница которых старше detach-after-months.
+        // Прерванный раньше DETACH CONCURRENTLY оставляет секцию в состоянии pending, ее дожимаем через FINALIZE
+        auto partitions = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT child.relname::text AS partition, inh.inhdetachpending AS pending "
+            "FROM pg_inherits inh "
+            "JOIN pg_class child ON child.oid = inh.inhrelid "
+            "WHERE inh.inhparent = $1::regclass "
+            "  AND child.relname ~ ('^' || $2 || '_p[0-9]{6}$') "
+            "  AND to_date(right(child.relname, 6), 'YYYYMM') + interval '1 month' "
+            "      <= date_trunc('month', now()) - $3 * interval '1 month' "
+            "ORDER BY child.relname",
+            table, table, detach_after_months_
+        );
+
+        for (const auto& row : partitions) {
+            const auto partition = row["partition"].As<std::string>();
+            const auto pending = row["pending"].As<bool>();
+
+            if (pending) {
+                // FINALIZE, как и CONCURRENTLY, не выполняется в блоке транзакции
+                pg_cluster_->Execute(
+                    userver::storages::postgres::ClusterHostType::kMaster,
+                    "ALTER TABLE " + table + " DETACH PARTITION " + partition + " FINALIZE"
+                );
+                pg_cluster_->Execute(
+                    userver::storages::postgres::ClusterHostType::kMaster,
+                    "ALTER TABLE " + partition + " SET SCHEMA " + archive_schema_
+                );
+            } else {
+                // При секции DEFAULT CONCURRENTLY недоступен. Обычный DETACH секцию не сканирует,
+                // но берет эксклюзивную блокировку таблицы, поэтому ждет ее не дольше lock_timeout
+                auto transaction = pg_cluster_->Begin(
+                    userver::storages::postgres::ClusterHostType::kMaster,
+                    userver::storages::postgres::TransactionOptions{},
+                    kDdlCommandControl
+                );
+                transaction.Execute(kSetLockTimeout);
+                transaction.Execute("ALTER TABLE " + table + " DETACH PARTITION " + partition);
+                transaction.Execute("ALTER TABLE " + partition + " SET SCHEMA " + archive_schema_);
+                transaction.Commit();
+            }
+
+            LOG_INFO() << "Partition " << partition << " detached into " << archive_schema_;
+        }
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to detach old partitions of " << table << ": " << ex.what();
+    }
+}
+
+void Maintenance::RefreshSizes() {
+    try {
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT parent.relname::text AS table_name, child.relname::text AS partition, "
+            "       pg_total_relation_size(child.oid) AS bytes, "
+            "       GREATEST(child.reltuples, 0)::bigint AS rows "
+            "FROM pg_inherits inh "
+            "JOIN pg_class parent ON parent.oid = inh.inhparent "
+            "JOIN pg_class child ON child.oid = inh.inhrelid "
+            "WHERE inh.inhparent = ANY(SELECT to_regclass(t) FROM UNNEST($1::text[]) AS t) "
+            "ORDER BY 1, 2",
+            tables_
+        );
+
+        std::vector<PartitionSize> sizes;
+        sizes.reserve(result.Size());
+        for (const auto& row : result) {
+            sizes.push_back({
+                row["table_name"].As<std::string>(),
+                row["partition"].As<std::string>(),
+                row["bytes"].As<std::int64_t>(),
+                row["rows"].As<std::int64_t>(),
+            });
+        }
+        sizes_.Assign(std::move(sizes));
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to refresh partition sizes: " << ex.what();
+    }
+}
+
+yaml_config::Schema Maintenance::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Creates, detaches and reports monthly created_at partitions
+additionalProperties: false
+properties:
+    tables:
+        type: array
+        description: partitioned tables in the service search_path
+        items:
+            type: string
+            description: table name
+    period:
+        type: string
+        description: how often partitions are maintained
+        defaultDescription: 1h
+    premake-months:
+        type: integer
+        description: how many months ahead partitions are created
+        defaultDescription: 3
+    detach-after-months:
+        type: integer
+        description: partitions older than this many months are detached; 0 keeps all partitions attached
+        defaultDescription: 0
+    archive-schema:
+        type: string
+        description: schema where detached partitions are moved
+        defaultDescription: ''
+)");
+}
+
+}  // namespace partitioning
@@ -80,6 +80,27 @@ class Cart {
         }
     }
 
+    // Опрашивает статус оформления, пока заказ не создан или не отклонен
+    async waitForCheckout(orderId, attempts = 30) {
+        let status = { status: 'PROCESSING' };
+
+        for (let i = 0; i < attempts && status.status === 'PROCESSING'; ++i) {
+            await new Promise(resolve => setTimeout(resolve, 1000));
+
+            const response = await fetch(`/api/orderservice/checkout-status?order_id=${orderId}`, {
+                headers: {
+                    'Authorization': `Bearer ${this.token}`
+                }
+            });
+
+            if (response.ok) {
+                status = await response.json();
+            }
+        }
+
+        return status;
+    }
+
     formatPrice(price) {
         return new Intl.NumberFormat('ru-RU').format(price);
     }
@@ -89,12 +110,11 @@ class Cart {
             if (this.button.classList.contains('disable')) return;
 
             try {
-                const token = IdempotencyToken.generate();
-                const response = await fetch('/api/cartservice/create-order', {
+                // Заказ оформляется асинхронно: orderservice сразу выдает номер заказа
+                const response = await fetch('/api/orderservice/checkout', {
                     method: 'POST',
                     headers: {
-                        'Authorization': `Bearer ${this.token}`,
-                        'Idempotency-Token': token
+                        'Authorization': `Bearer ${this.token}`
                     }
                 });
                 
@@ -103,14 +123,31 @@ class Cart {
                     return;
                 }
 
-                if (response.status === 204) {
-                    alert('Ваш заказ успешно создан. Его оплата будет проведена в течении 10 секунд.\n\nЕсли средств на счете достаточно, то она будет проведена успешно с вероятностью 50%. Если оплата не удастся, товары вернутся обратно в корзину, и вы сможете повторить попытку оплаты снова.\n\nЗа ходом исполнения вашего заказа можете следить на вкладке "Заказы"');
-                    location.reload();
-                } else {
+                if (response.status === 429) {
+                    const retryAfter = response.headers.get('Retry-After') || 10;
+                    alert(`Сейчас оформляется слишком много заказов.\n\nПопробуйте снова через ${retryAfter} с.`);
+                    return;
+                }
+
+                if (response.status !== 202) {
                     throw new Error(`HTTP error: ${response.status}`);
-                    location.reload();
                 }
 
+                this.button.classList.add('disable');
+                const { order_id } = await response.json();
+                const status = await this.waitForCheckout(order_id);
+
+                if (status.status === 'CREATED') {
+                    alert(`Ваш заказ №${order_id} успешно создан. Его оплата будет проведена в течении 10 секунд.\n\nЕсли средств на счете достаточно, то она будет проведена успешно с вероятностью 50%. Если оплата не удастся, товары вернутся обратно в корзину, и вы сможете повторить попытку оплаты снова.\n\nЗа ходом исполнения вашего заказа можете следить на вкладке "Заказы"`);
+                } else if (status.status === 'REJECTED') {
+                    alert(`Не удалось оформить заказ: ${status.error}`);
+                } else if (status.status === 'FAILED') {
+                    alert('Произошла ошибка на сервере.\n\nСоздать заказ временно не получится. Попробуйте позже');
+                } else {
+                    alert(`Заказ №${order_id} принят и еще оформляется.\n\nЗа ходом исполнения вашего заказа можете следить на вкладке "Заказы"`);
+                }
+                location.reload();
+
             } catch (error) {
                 if (error.name === 'TypeError') {
                     alert('Произошла ошибка при соединении с сервером.\n\nСоздать заказ временно не получится. Попробуйте позже');
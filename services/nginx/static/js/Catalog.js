@@ -22,7 +22,7 @@ class Catalog {
             }
 
             const data = await response.json();
-            this.renderProducts(data.products);
+            this.renderProducts(data.products, data.order);
         } catch (error) {
             console.error('Ошибка при загрузке товаров:', error);
             this.productsGrid.innerHTML = '<p class="error-message">Не удалось загрузить товары. Попробуйте позже.</p>';
@@ -33,7 +33,8 @@ class Catalog {
         return new Intl.NumberFormat('ru-RU').format(price);
     }
 
-    renderProducts(products) {
+    // order - артикулы в порядке показа (например, по популярности)
+    renderProducts(products, order) {
         if (!products || Object.keys(products).length === 0) {
             this.productsGrid.innerHTML = '<p class="no-products">Товары не найдены</p>';
             return;
@@ -41,8 +42,8 @@ class Catalog {
 
         this.productsGrid.innerHTML = '';
         
-        for (const [article, product] of Object.entries(products)) {
-            const productCard = this.createProductCard(article, product);
+        for (const article of (order || Object.keys(products))) {
+            const productCard = this.createProductCard(article, products[article]);
             this.productsGrid.appendChild(productCard);
         }
     }
@@ -2,11 +2,24 @@ class Orders {
     constructor() {
         this.container = document.getElementById('orders-container');
         this.token = localStorage.getItem('jwt_token');
+        this.orders = [];
+        this.nextCursor = null;
+        this.eventsCursor = null;
+    }
+
+    buildOrdersUrl() {
+        const params = new URLSearchParams();
+        if (this.nextCursor) {
+            params.set('before_created_at', this.nextCursor.before_created_at);
+            params.set('before_id', this.nextCursor.before_id);
+        }
+        const query = params.toString();
+        return '/api/orderservice/fetch-orders-bulk' + (query ? `?${query}` : '');
     }
 
     async fetchAndRenderOrders() {
         try {
-            const response = await fetch('/api/orderservice/fetch-orders-bulk', {
+            const response = await fetch(this.buildOrdersUrl(), {
                 headers: {
                     'Authorization': `Bearer ${this.token}`
                 }
@@ -22,13 +35,70 @@ class Orders {
             }
 
             const data = await response.json();
-            this.renderOrders(data.orders || []);
+            this.orders = this.orders.concat(data.orders || []);
+            this.nextCursor = data.next_cursor || null;
+            this.renderOrders(this.orders);
         } catch (error) {
             console.error('Ошибка при загрузке заказов:', error);
             this.container.innerHTML = '<p class="error-message">Не удалось загрузить заказы. Попробуйте позже.</p>';
         }
     }
 
+    // Long-poll смены статусов: сервер держит запрос, пока не появится событие или не истечет ожидание
+    async subscribeToEvents() {
+        while (true) {
+            try {
+                const params = new URLSearchParams();
+                if (this.eventsCursor !== null) {
+                    params.set('after', this.eventsCursor);
+                }
+                const query = params.toString();
+
+                const response = await fetch('/api/orderservice/order-events' + (query ? `?${query}` : ''), {
+                    headers: {
+                        'Authorization': `Bearer ${this.token}`
+                    }
+                });
+
+                if (response.status === 401 || response.status === 403) {
+                    return;
+                }
+
+                if (!response.ok) {
+                    throw new Error(`Ошибка HTTP: ${response.status}`);
+                }
+
+                const data = await response.json();
+                this.eventsCursor = data.cursor;
+                if (data.reset) {
+                    // Часть событий могла потеряться - перечитываем заказы с первой страницы
+                    this.orders = [];
+                    this.nextCursor = null;
+                    await this.fetchAndRenderOrders();
+                    continue;
+                }
+                (data.events || []).forEach(event => this.applyStatusEvent(event));
+            } catch (error) {
+                console.error('Ошибка при получении событий заказов:', error);
+                await new Promise(resolve => setTimeout(resolve, 3000));
+            }
+        }
+    }
+
+    applyStatusEvent(event) {
+        const order = this.orders.find(item => item.order_id === event.order_id);
+        if (!order) {
+            return;
+        }
+        order.status = event.status;
+
+        const statusElement = this.container.querySelector(`.order-card[data-order-id="${event.order_id}"] .order-status`);
+        if (statusElement) {
+            statusElement.className = `order-status ${event.status}`;
+            statusElement.textContent = event.status;
+        }
+    }
+
     renderAuthMessage() {
         this.container.innerHTML = `
             <div class="auth-message">
@@ -54,11 +124,23 @@ class Orders {
 
         this.container.innerHTML = '';
         this.container.appendChild(list);
+
+        if (this.nextCursor) {
+            const moreButton = document.createElement('button');
+            moreButton.className = 'load-more-button';
+            moreButton.textContent = 'Показать еще';
+            moreButton.addEventListener('click', () => {
+                moreButton.disabled = true;
+                this.fetchAndRenderOrders();
+            });
+            this.container.appendChild(moreButton);
+        }
     }
 
     createOrderCard(order) {
         const card = document.createElement('div');
         card.className = 'order-card';
+        card.dataset.orderId = order.order_id;
 
         const createdAt = new Date(order.created_at).toLocaleString('ru-RU');
         const amount = new Intl.NumberFormat('ru-RU').format(order.total_amount);
@@ -0,0 +1,6 @@
+\connect fzon
+
+-- Покрывающий индекс под историю заказов пользователя с keyset-пагинацией по (created_at, id)
+CREATE INDEX IF NOT EXISTS orders_user_id_created_at_idx
+    ON orderserviceschema.orders (user_id, created_at DESC, id DESC)
+    INCLUDE (total_amount, status);
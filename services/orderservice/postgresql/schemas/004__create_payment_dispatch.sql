@@ -0,0 +1,19 @@
+\connect fzon
+
+-- Запросы на оплату, ожидающие доставки в bankservice.
+-- Запись создается в транзакции создания заказа, доставляет ее payment-dispatcher вне этой транзакции
+CREATE TABLE IF NOT EXISTS orderserviceschema.payment_dispatch (
+    order_id INTEGER PRIMARY KEY REFERENCES orderserviceschema.orders(id) ON DELETE CASCADE,
+    user_id INTEGER NOT NULL,
+    amount NUMERIC(10,2) NOT NULL,
+    status VARCHAR(20) NOT NULL DEFAULT 'DISPATCHING', -- DISPATCHING, DELIVERED, FAILED
+    attempts INTEGER NOT NULL DEFAULT 0,
+    next_attempt_at TIMESTAMPTZ NOT NULL DEFAULT now(),
+    last_error TEXT,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT now(),
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT now()
+);
+
+CREATE INDEX IF NOT EXISTS payment_dispatch_pending_idx
+    ON orderserviceschema.payment_dispatch (next_attempt_at)
+    WHERE status = 'DISPATCHING';
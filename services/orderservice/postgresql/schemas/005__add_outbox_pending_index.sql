@@ -0,0 +1,11 @@
+\connect fzon
+
+-- Частичный индекс только по необработанным записям: выборка OutboxWorker не зависит от объема истории
+CREATE INDEX IF NOT EXISTS outbox_pending_idx
+    ON orderserviceschema.outbox (id)
+    WHERE processed = false;
+
+-- Для архивации обработанных записей по возрасту
+CREATE INDEX IF NOT EXISTS outbox_processed_created_at_idx
+    ON orderserviceschema.outbox (created_at)
+    WHERE processed = true;
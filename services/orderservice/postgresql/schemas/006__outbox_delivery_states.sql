@@ -0,0 +1,44 @@
+\connect fzon
+
+-- Состояния записей для общего outbox-консьюмера (services/libs/outbox):
+-- PENDING -> DELIVERY -> DONE, после max-attempts неудачных попыток - DEAD
+ALTER TABLE orderserviceschema.outbox
+    ADD COLUMN IF NOT EXISTS status VARCHAR(20) NOT NULL DEFAULT 'PENDING',
+    ADD COLUMN IF NOT EXISTS attempts INTEGER NOT NULL DEFAULT 0,
+    ADD COLUMN IF NOT EXISTS next_attempt_at TIMESTAMPTZ NOT NULL DEFAULT now(),
+    ADD COLUMN IF NOT EXISTS last_error TEXT,
+    ADD COLUMN IF NOT EXISTS delivery JSONB;
+
+UPDATE orderserviceschema.outbox SET status = 'DONE' WHERE processed;
+
+-- Недоставленные запросы на оплату переезжают из payment_dispatch в outbox
+INSERT INTO orderserviceschema.outbox (user_id, payload, status, attempts, next_attempt_at, delivery)
+SELECT user_id, '{}'::jsonb, 'DELIVERY', attempts, next_attempt_at,
+       jsonb_build_object('order_id', order_id, 'user_id', user_id, 'amount', amount::float8)
+FROM orderserviceschema.payment_dispatch
+WHERE status = 'DISPATCHING';
+
+DROP TABLE orderserviceschema.payment_dispatch;
+
+DROP INDEX IF EXISTS orderserviceschema.outbox_pending_idx;
+DROP INDEX IF EXISTS orderserviceschema.outbox_processed_created_at_idx;
+ALTER TABLE orderserviceschema.outbox DROP COLUMN processed;
+
+-- Выборка консьюмера и метрики backlog
+CREATE INDEX IF NOT EXISTS outbox_pending_idx
+    ON orderserviceschema.outbox (id)
+    WHERE status IN ('PENDING', 'DELIVERY');
+
+-- Проверка, что более ранняя запись пользователя не ждет повтора
+CREATE INDEX IF NOT EXISTS outbox_pending_user_idx
+    ON orderserviceschema.outbox (user_id, id)
+    WHERE status = 'PENDING';
+
+CREATE INDEX IF NOT EXISTS outbox_dead_idx
+    ON orderserviceschema.outbox (id)
+    WHERE status = 'DEAD';
+
+-- Для архивации обработанных записей по возрасту
+CREATE INDEX IF NOT EXISTS outbox_done_created_at_idx
+    ON orderserviceschema.outbox (created_at)
+    WHERE status = 'DONE';
@@ -0,0 +1,45 @@
+\connect fzon
+
+-- Асинхронное оформление заказа: /checkout резервирует id заказа и кладет задачу в checkout_outbox,
+-- checkout-worker читает корзину и создает заказ через обычный outbox
+CREATE TABLE IF NOT EXISTS orderserviceschema.checkout_outbox (
+    id SERIAL PRIMARY KEY,
+    user_id INTEGER NOT NULL,
+    payload JSONB NOT NULL,
+    created_at TIMESTAMP DEFAULT now(),
+    status VARCHAR(20) NOT NULL DEFAULT 'PENDING',
+    attempts INTEGER NOT NULL DEFAULT 0,
+    next_attempt_at TIMESTAMPTZ NOT NULL DEFAULT now(),
+    last_error TEXT,
+    delivery JSONB
+);
+
+CREATE INDEX IF NOT EXISTS checkout_outbox_pending_idx
+    ON orderserviceschema.checkout_outbox (id)
+    WHERE status IN ('PENDING', 'DELIVERY');
+
+CREATE INDEX IF NOT EXISTS checkout_outbox_pending_user_idx
+    ON orderserviceschema.checkout_outbox (user_id, id)
+    WHERE status = 'PENDING';
+
+CREATE INDEX IF NOT EXISTS checkout_outbox_dead_idx
+    ON orderserviceschema.checkout_outbox (id)
+    WHERE status = 'DEAD';
+
+CREATE INDEX IF NOT EXISTS checkout_outbox_done_created_at_idx
+    ON orderserviceschema.checkout_outbox (created_at)
+    WHERE status = 'DONE';
+
+-- Состояние оформления: ACCEPTED -> ORDERED (корзина прочитана, запись в outbox создана)
+-- или REJECTED (корзина пуста или у товаров нет цены). order_id совпадает с id будущего заказа
+CREATE TABLE IF NOT EXISTS orderserviceschema.checkouts (
+    order_id INTEGER PRIMARY KEY,
+    user_id INTEGER NOT NULL,
+    status VARCHAR(20) NOT NULL DEFAULT 'ACCEPTED',
+    error TEXT,
+    items JSONB,
+    checkout_outbox_id INTEGER NOT NULL,
+    outbox_id INTEGER,
+    created_at TIMESTAMP NOT NULL DEFAULT now(),
+    updated_at TIMESTAMP NOT NULL DEFAULT now()
+);
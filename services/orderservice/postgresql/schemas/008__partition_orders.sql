@@ -0,0 +1,136 @@
+\connect fzon
+
+-- orders и order_items секционируются по месяцам created_at (RANGE).
+-- Секция таблицы T за месяц YYYYMM называется T_pYYYYMM; будущие секции создает
+-- и старые отсоединяет в orderservicearchive компонент partition-maintenance (services/libs/partitioning).
+-- order_items хранит created_at своего заказа, чтобы товары заказа лежали в секции того же месяца.
+-- Внешний ключ order_items -> orders убран: он мешал бы отсоединять секции
+
+CREATE SCHEMA IF NOT EXISTS orderservicearchive;
+
+CREATE TABLE orderserviceschema.orders_partitioned (
+    id INTEGER NOT NULL,
+    user_id INTEGER NOT NULL,
+    total_amount NUMERIC(10,2) NOT NULL,
+    status VARCHAR(20) NOT NULL DEFAULT 'PENDING',
+    created_at TIMESTAMP NOT NULL DEFAULT now(),
+    PRIMARY KEY (id, created_at)
+) PARTITION BY RANGE (created_at);
+
+CREATE TABLE orderserviceschema.order_items_partitioned (
+    order_id INTEGER NOT NULL,
+    article VARCHAR(20) NOT NULL,
+    quantity INTEGER NOT NULL,
+    price NUMERIC(10,2) NOT NULL,
+    created_at TIMESTAMP NOT NULL,
+    PRIMARY KEY (order_id, created_at, article)
+) PARTITION BY RANGE (created_at);
+
+-- Секции от месяца самого старого заказа до трех месяцев вперед
+DO $$
+DECLARE
+    v_month DATE := date_trunc('month', COALESCE((SELECT MIN(created_at) FROM orderserviceschema.orders), now()))::date;
+    v_last DATE := (date_trunc('month', now()) + interval '3 months')::date;
+BEGIN
+    WHILE v_month <= v_last LOOP
+        EXECUTE format(
+            'CREATE TABLE orderserviceschema.%I PARTITION OF orderserviceschema.orders_partitioned '
+            'FOR VALUES FROM (%L) TO (%L)',
+            'orders_p' || to_char(v_month, 'YYYYMM'), v_month, (v_month + interval '1 month')::date
+        );
+        EXECUTE format(
+            'CREATE TABLE orderserviceschema.%I PARTITION OF orderserviceschema.order_items_partitioned '
+            'FOR VALUES FROM (%L) TO (%L)',
+            'order_items_p' || to_char(v_month, 'YYYYMM'), v_month, (v_month + interval '1 month')::date
+        );
+        v_month := (v_month + interval '1 month')::date;
+    END LOOP;
+END $$;
+
+UPDATE orderserviceschema.orders SET created_at = now() WHERE created_at IS NULL;
+
+INSERT INTO orderserviceschema.orders_partitioned (id, user_id, total_amount, status, created_at)
+SELECT id, user_id, total_amount, status, created_at FROM orderserviceschema.orders;
+
+INSERT INTO orderserviceschema.order_items_partitioned (order_id, article, quantity, price, created_at)
+SELECT oi.order_id, oi.article, oi.quantity, oi.price, o.created_at
+FROM orderserviceschema.order_items oi
+JOIN orderserviceschema.orders o ON o.id = oi.order_id;
+
+-- Последовательность id остается прежней: на нее ссылаются CreateOrder и Checkout
+ALTER SEQUENCE orderserviceschema.orders_id_seq OWNED BY NONE;
+
+DROP TABLE orderserviceschema.order_items;
+DROP TABLE orderserviceschema.orders;
+
+ALTER TABLE orderserviceschema.orders_partitioned RENAME TO orders;
+ALTER TABLE orderserviceschema.order_items_partitioned RENAME TO order_items;
+ALTER INDEX orderserviceschema.orders_partitioned_pkey RENAME TO orders_pkey;
+ALTER INDEX orderserviceschema.order_items_partitioned_pkey RENAME TO order_items_pkey;
+
+ALTER TABLE orderserviceschema.orders
+    ALTER COLUMN id SET DEFAULT nextval('orderserviceschema.orders_id_seq');
+ALTER SEQUENCE orderserviceschema.orders_id_seq OWNED BY orderserviceschema.orders.id;
+
+-- История заказов пользователя; created_at в ключе позволяет отсекать секции по курсору
+CREATE INDEX IF NOT EXISTS orders_user_id_created_at_idx
+    ON orderserviceschema.orders (user_id, created_at DESC, id DESC)
+    INCLUDE (total_amount, status);
+
+-- Товары заказа ищутся по (order_id, created_at) заказа, чтобы читать одну секцию
+CREATE OR REPLACE FUNCTION orderserviceschema.refresh_user_order_history(p_user_id INTEGER)
+RETURNS void AS $$
+DECLARE
+    v_page_size CONSTANT INTEGER := 20;
+    v_orders JSONB;
+    v_next_cursor JSONB;
+BEGIN
+    WITH recent AS (
+        SELECT o.id, o.created_at, o.total_amount, o.status,
+               row_number() OVER (ORDER BY o.created_at DESC, o.id DESC) AS rn
+        FROM (
+            SELECT id, created_at, total_amount, status
+            FROM orderserviceschema.orders
+            WHERE user_id = p_user_id
+            ORDER BY created_at DESC, id DESC
+            LIMIT v_page_size + 1
+        ) o
+    )
+    SELECT
+        COALESCE(
+            jsonb_agg(
+                jsonb_build_object(
+                    'order_id', r.id,
+                    'total_amount', r.total_amount::float8,
+                    'status', r.status,
+                    'created_at', to_char(r.created_at, 'YYYY-MM-DD"T"HH24:MI:SS.US"+0000"'),
+                    'items', COALESCE((
+                        SELECT jsonb_agg(jsonb_build_object(
+                            'article', oi.article, 'quantity', oi.quantity, 'price', oi.price::float8
+                        ))
+                        FROM orderserviceschema.order_items oi
+                        WHERE oi.order_id = r.id AND oi.created_at = r.created_at
+                    ), '[]'::jsonb)
+                ) ORDER BY r.rn
+            ) FILTER (WHERE r.rn <= v_page_size),
+            '[]'::jsonb
+        ),
+        (
+            SELECT jsonb_build_object(
+                'before_created_at', to_char(boundary.created_at, 'YYYY-MM-DD"T"HH24:MI:SS.US"+0000"'),
+                'before_id', boundary.id
+            )
+            FROM recent boundary
+            WHERE boundary.rn = v_page_size AND EXISTS (SELECT 1 FROM recent WHERE rn > v_page_size)
+        )
+    INTO v_orders, v_next_cursor
+    FROM recent r;
+
+    INSERT INTO orderserviceschema.user_order_history (user_id, orders, next_cursor, updated_at)
+    VALUES (p_user_id, v_orders, v_next_cursor, now())
+    ON CONFLICT (user_id) DO UPDATE
+        SET orders = EXCLUDED.orders,
+            next_cursor = EXCLUDED.next_cursor,
+            updated_at = EXCLUDED.updated_at;
+END;
+$$ LANGUAGE plpgsql;
@@ -0,0 +1,56 @@
+\connect fzon
+
+-- Продавец товара на момент заказа (cart_items.seller_name), для агрегатов по продавцам.
+-- У заказов до этой миграции продавец неизвестен, в seller_sales_stats они не попадают
+ALTER TABLE orderserviceschema.order_items ADD COLUMN IF NOT EXISTS seller_name VARCHAR(255);
+
+-- Агрегаты для профиля пользователя. orders_count растет при создании заказа (OutboxWorker),
+-- paid_orders_count и total_spent - при переходе заказа в PAID (PaymentResult)
+CREATE TABLE IF NOT EXISTS orderserviceschema.user_order_stats (
+    user_id INTEGER PRIMARY KEY,
+    orders_count BIGINT NOT NULL DEFAULT 0,
+    paid_orders_count BIGINT NOT NULL DEFAULT 0,
+    total_spent NUMERIC(14,2) NOT NULL DEFAULT 0,
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT now()
+);
+
+-- Агрегаты для страницы продавца по оплаченным заказам, обновляются в PaymentResult
+CREATE TABLE IF NOT EXISTS orderserviceschema.seller_sales_stats (
+    seller_name VARCHAR(255) PRIMARY KEY,
+    orders_count BIGINT NOT NULL DEFAULT 0,
+    units_sold BIGINT NOT NULL DEFAULT 0,
+    revenue NUMERIC(14,2) NOT NULL DEFAULT 0,
+    updated_at TIMESTAMPTZ NOT NULL DEFAULT now()
+);
+
+-- Пересчитывает оба агрегата с нуля (backfill и восстановление после расхождений).
+-- Блокировка на время пересчета задерживает инкрементальные обновления: транзакции,
+-- закоммиченные до нее, уже видны пересчету, остальные применят свои приращения после
+CREATE OR REPLACE FUNCTION orderserviceschema.rebuild_order_stats()
+RETURNS void AS $$
+BEGIN
+    LOCK TABLE orderserviceschema.user_order_stats, orderserviceschema.seller_sales_stats IN EXCLUSIVE MODE;
+
+    DELETE FROM orderserviceschema.user_order_stats;
+    INSERT INTO orderserviceschema.user_order_stats (user_id, orders_count, paid_orders_count, total_spent)
+    SELECT user_id,
+           COUNT(*),
+           COUNT(*) FILTER (WHERE status = 'PAID'),
+           COALESCE(SUM(total_amount) FILTER (WHERE status = 'PAID'), 0)
+    FROM orderserviceschema.orders
+    GROUP BY user_id;
+
+    DELETE FROM orderserviceschema.seller_sales_stats;
+    INSERT INTO orderserviceschema.seller_sales_stats (seller_name, orders_count, units_sold, revenue)
+    SELECT oi.seller_name,
+           COUNT(DISTINCT o.id),
+           SUM(oi.quantity),
+           SUM(oi.quantity * oi.price)
+    FROM orderserviceschema.orders o
+    JOIN orderserviceschema.order_items oi ON oi.order_id = o.id AND oi.created_at = o.created_at
+    WHERE o.status = 'PAID' AND oi.seller_name IS NOT NULL
+    GROUP BY oi.seller_name;
+END;
+$$ LANGUAGE plpgsql;
+
+SELECT orderserviceschema.rebuild_order_stats();
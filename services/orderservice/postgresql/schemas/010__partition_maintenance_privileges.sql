@@ -0,0 +1,34 @@
+\connect fzon
+
+-- partition-maintenance работает под ролью сервиса (ORDER_DB_USER из .env, здесь orderservice),
+-- а orders и order_items пересоздала миграция 008 под суперпользователем.
+-- Создавать, отсоединять и переносить секции может только владелец таблицы,
+-- поэтому таблицы со всеми секциями передаются роли сервиса, а на обе схемы выдается CREATE
+
+GRANT USAGE, CREATE ON SCHEMA orderserviceschema TO orderservice;
+GRANT USAGE, CREATE ON SCHEMA orderservicearchive TO orderservice;
+
+-- Секции по умолчанию: строка, для месяца которой секция еще не создана, не ломает вставку.
+-- partition-maintenance переносит такие строки в секцию месяца, когда создает ее
+CREATE TABLE IF NOT EXISTS orderserviceschema.orders_default
+    PARTITION OF orderserviceschema.orders DEFAULT;
+CREATE TABLE IF NOT EXISTS orderserviceschema.order_items_default
+    PARTITION OF orderserviceschema.order_items DEFAULT;
+
+-- ALTER TABLE ... OWNER не переходит на секции, их меняем по одной.
+-- Последовательность orders_id_seq переходит вместе с orders
+DO $$
+DECLARE
+    v_table REGCLASS;
+BEGIN
+    FOR v_table IN
+        SELECT inh.inhrelid::regclass
+        FROM pg_inherits inh
+        WHERE inh.inhparent IN ('orderserviceschema.orders'::regclass, 'orderserviceschema.order_items'::regclass)
+    LOOP
+        EXECUTE format('ALTER TABLE %s OWNER TO orderservice', v_table);
+    END LOOP;
+END $$;
+
+ALTER TABLE orderserviceschema.orders OWNER TO orderservice;
+ALTER TABLE orderserviceschema.order_items OWNER TO orderservice;
@@ -0,0 +1,68 @@
+\connect fzon
+
+-- Пересборки истории одного пользователя сериализуются advisory-блокировкой на транзакцию.
+-- Без нее две параллельные пересборки (создание заказа, оплата, backfill) читают orders
+-- в разных снимках, и последним может записаться более старый вариант истории.
+-- В READ COMMITTED запрос после блокировки берет новый снимок и видит все
+-- закоммиченные к этому моменту заказы
+
+CREATE OR REPLACE FUNCTION orderserviceschema.refresh_user_order_history(p_user_id INTEGER)
+RETURNS void AS $$
+DECLARE
+    v_page_size CONSTANT INTEGER := 20;
+    v_orders JSONB;
+    v_next_cursor JSONB;
+BEGIN
+    -- Читать orders можно только после блокировки: иначе транзакция со старым снимком
+    -- может перезаписать историю, уже собранную параллельной транзакцией с новым заказом
+    PERFORM pg_advisory_xact_lock(hashtext('user_order_history'), p_user_id);
+
+    WITH recent AS (
+        SELECT o.id, o.created_at, o.total_amount, o.status,
+               row_number() OVER (ORDER BY o.created_at DESC, o.id DESC) AS rn
+        FROM (
+            SELECT id, created_at, total_amount, status
+            FROM orderserviceschema.orders
+            WHERE user_id = p_user_id
+            ORDER BY created_at DESC, id DESC
+            LIMIT v_page_size + 1
+        ) o
+    )
+    SELECT
+        COALESCE(
+            jsonb_agg(
+                jsonb_build_object(
+                    'order_id', r.id,
+                    'total_amount', r.total_amount::float8,
+                    'status', r.status,
+                    'created_at', to_char(r.created_at, 'YYYY-MM-DD"T"HH24:MI:SS.US"+0000"'),
+                    'items', COALESCE((
+                        SELECT jsonb_agg(jsonb_build_object(
+                            'article', oi.article, 'quantity', oi.quantity, 'price', oi.price::float8
+                        ))
+                        FROM orderserviceschema.order_items oi
+                        WHERE oi.order_id = r.id AND oi.created_at = r.created_at
+                    ), '[]'::jsonb)
+                ) ORDER BY r.rn
+            ) FILTER (WHERE r.rn <= v_page_size),
+            '[]'::jsonb
+        ),
+        (
+            SELECT jsonb_build_object(
+                'before_created_at', to_char(boundary.created_at, 'YYYY-MM-DD"T"HH24:MI:SS.US"+0000"'),
+                'before_id', boundary.id
+            )
+            FROM recent boundary
+            WHERE boundary.rn = v_page_size AND EXISTS (SELECT 1 FROM recent WHERE rn > v_page_size)
+        )
+    INTO v_orders, v_next_cursor
+    FROM recent r;
+
+    INSERT INTO orderserviceschema.user_order_history (user_id, orders, next_cursor, updated_at)
+    VALUES (p_user_id, v_orders, v_next_cursor, now())
+    ON CONFLICT (user_id) DO UPDATE
+        SET orders = EXCLUDED.orders,
+            next_cursor = EXCLUDED.next_cursor,
+            updated_at = EXCLUDED.updated_at;
+END;
+$$ LANGUAGE plpgsql;
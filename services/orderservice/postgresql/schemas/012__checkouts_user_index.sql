@@ -0,0 +1,6 @@
+\connect fzon
+
+-- checkout-worker перед чтением корзины ищет незавершенные оформления того же пользователя
+CREATE INDEX IF NOT EXISTS checkouts_user_id_ordered_idx
+    ON orderserviceschema.checkouts (user_id)
+    WHERE status = 'ORDERED';
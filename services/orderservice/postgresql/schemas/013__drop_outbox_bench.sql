@@ -0,0 +1,4 @@
+\connect fzon
+
+-- Таблица нагрузочного прогона переехала в схему outboxbench, которую создает run-outbox-bench
+DROP TABLE IF EXISTS orderserviceschema.outbox_bench;
@@ -0,0 +1,56 @@
+\connect fzon
+
+-- rebuild_order_stats() держал EXCLUSIVE на обеих таблицах агрегатов все время пересчета,
+-- и на большой истории создание и оплата заказов стояли до его конца.
+-- Теперь пересчет идет по одному пользователю или продавцу на транзакцию (RebuildOrderStats),
+-- и блокируется только одна строка агрегата.
+-- Первый запрос берет блокировку строки и ждет транзакции, уже изменившие ее.
+-- В READ COMMITTED каждый следующий запрос volatile-функции берет новый снимок,
+-- поэтому пересчет видит их заказы, а транзакции после блокировки применят свои приращения сами
+
+DROP FUNCTION IF EXISTS orderserviceschema.rebuild_order_stats();
+
+CREATE OR REPLACE FUNCTION orderserviceschema.rebuild_user_order_stats(p_user_id INTEGER)
+RETURNS void AS $$
+BEGIN
+    INSERT INTO orderserviceschema.user_order_stats (user_id) VALUES (p_user_id)
+    ON CONFLICT (user_id) DO UPDATE SET updated_at = now();
+
+    UPDATE orderserviceschema.user_order_stats s
+    SET orders_count = o.orders_count,
+        paid_orders_count = o.paid_orders_count,
+        total_spent = o.total_spent,
+        updated_at = now()
+    FROM (
+        SELECT COUNT(*) AS orders_count,
+               COUNT(*) FILTER (WHERE status = 'PAID') AS paid_orders_count,
+               COALESCE(SUM(total_amount) FILTER (WHERE status = 'PAID'), 0) AS total_spent
+        FROM orderserviceschema.orders
+        WHERE user_id = p_user_id
+    ) o
+    WHERE s.user_id = p_user_id;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE OR REPLACE FUNCTION orderserviceschema.rebuild_seller_sales_stats(p_seller_name VARCHAR)
+RETURNS void AS $$
+BEGIN
+    INSERT INTO orderserviceschema.seller_sales_stats (seller_name) VALUES (p_seller_name)
+    ON CONFLICT (seller_name) DO UPDATE SET updated_at = now();
+
+    UPDATE orderserviceschema.seller_sales_stats s
+    SET orders_count = o.orders_count,
+        units_sold = o.units_sold,
+        revenue = o.revenue,
+        updated_at = now()
+    FROM (
+        SELECT COUNT(DISTINCT o.id) AS orders_count,
+               COALESCE(SUM(oi.quantity), 0) AS units_sold,
+               COALESCE(SUM(oi.quantity * oi.price), 0) AS revenue
+        FROM orderserviceschema.orders o
+        JOIN orderserviceschema.order_items oi ON oi.order_id = o.id AND oi.created_at = o.created_at
+        WHERE o.status = 'PAID' AND oi.seller_name = p_seller_name
+    ) o
+    WHERE s.seller_name = p_seller_name;
+END;
+$$ LANGUAGE plpgsql;
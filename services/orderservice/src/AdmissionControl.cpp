@@ -0,0 +1,126 @@
+#include "AdmissionControl.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/components/statistics_storage.hpp>
+#include <userver/dynamic_config/storage/component.hpp>
+#include <userver/dynamic_config/value.hpp>
+#include <userver/engine/deadline.hpp>
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/utils/statistics/writer.hpp>
+
+#include <algorithm>
+
+namespace orderservice {
+
+namespace {
+
+// Значения по умолчанию продублированы в секции dynamic-config static_config.yaml.
+// Порог 0 отключает соответствующую проверку
+const dynamic_config::Key<std::int64_t> kMaxOutboxPending{"ORDERSERVICE_ADMISSION_MAX_OUTBOX_PENDING", 1000};
+const dynamic_config::Key<std::int64_t> kMaxOutboxAgeMs{"ORDERSERVICE_ADMISSION_MAX_OUTBOX_AGE_MS", 60000};
+// 0 - отказывать сразу, без ожидания в очереди
+const dynamic_config::Key<std::int64_t> kQueueTimeoutMs{"ORDERSERVICE_ADMISSION_QUEUE_TIMEOUT_MS", 0};
+const dynamic_config::Key<std::int64_t> kRetryAfterSeconds{"ORDERSERVICE_ADMISSION_RETRY_AFTER_S", 10};
+
+}  // namespace
+
+AdmissionControl::AdmissionControl(const components::ComponentConfig& config,
+                                   const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      max_queued_(config["max-queued"].As<std::size_t>(100)),
+      queue_check_interval_(config["queue-check-interval"].As<std::chrono::milliseconds>(std::chrono::milliseconds{200})),
+      config_source_(component_context.FindComponent<components::DynamicConfig>().GetSource()),
+      archiver_(component_context.FindComponent<outbox::Archiver>())
+{
+    auto& storage = component_context.FindComponent<components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("admission", [this](utils::statistics::Writer& writer) {
+        writer["admitted"] = admitted_.Load();
+        writer["queued"] = queued_total_.Load();
+        writer["rejected"] = rejected_.Load();
+        writer["waiting"] = queued_.load();
+        writer["overloaded"] = IsOverloaded() ? 1 : 0;
+    });
+}
+
+AdmissionControl::~AdmissionControl() {
+    statistics_holder_.Unregister();
+}
+
+bool AdmissionControl::IsOverloaded() const {
+    const auto snapshot = config_source_.GetSnapshot();
+    const auto max_pending = snapshot[kMaxOutboxPending];
+    const auto max_age_ms = snapshot[kMaxOutboxAgeMs];
+
+    if (max_pending > 0 && archiver_.GetPendingCount() >= max_pending) {
+        return true;
+    }
+    return max_age_ms > 0 && archiver_.GetOldestPendingAgeSeconds() * 1000.0 >= static_cast<double>(max_age_ms);
+}
+
+AdmissionControl::Decision AdmissionControl::Check() const {
+    if (!IsOverloaded()) {
+        return {};
+    }
+    return {false, std::max<std::int64_t>(config_source_.GetCopy(kRetryAfterSeconds), 1)};
+}
+
+AdmissionControl::Decision AdmissionControl::Admit() {
+    if (!IsOverloaded()) {
+        admitted_.Add(utils::statistics::Rate{1});
+        return {};
+    }
+
+    const auto queue_timeout = std::chrono::milliseconds{config_source_.GetCopy(kQueueTimeoutMs)};
+
+    // Очередь ограничена, чтобы ожидающие запросы не занимали все соединения
+    if (queue_timeout.count() > 0) {
+        bool overloaded = true;
+
+        if (queued_.fetch_add(1) < max_queued_) {
+            queued_total_.Add(utils::statistics::Rate{1});
+            const auto deadline = engine::Deadline::FromDuration(queue_timeout);
+
+            while (overloaded && !deadline.IsReached() && !engine::current_task::ShouldCancel()) {
+                engine::InterruptibleSleepFor(std::min<std::chrono::milliseconds>(
+                    queue_check_interval_,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(deadline.TimeLeft())
+                ));
+                overloaded = IsOverloaded();
+            }
+        }
+        --queued_;
+
+        if (!overloaded) {
+            admitted_.Add(utils::statistics::Rate{1});
+            return {};
+        }
+    }
+
+    rejected_.Add(utils::statistics::Rate{1});
+    LOG_LIMITED_WARNING() << "Order rejected by admission control: outbox pending "
+                          << archiver_.GetPendingCount() << ", oldest "
+                          << archiver_.GetOldestPendingAgeSeconds() << "s";
+
+    return {false, std::max<std::int64_t>(config_source_.GetCopy(kRetryAfterSeconds), 1)};
+}
+
+yaml_config::Schema AdmissionControl::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Admission control for new orders driven by outbox backlog
+additionalProperties: false
+properties:
+    max-queued:
+        type: integer
+        description: how many requests may wait for the backlog to drain at once
+        defaultDescription: 100
+    queue-check-interval:
+        type: string
+        description: how often a waiting request re-checks the backlog
+        defaultDescription: 200ms
+)");
+}
+
+}  // namespace orderservice
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/dynamic_config/source.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <outbox/Archiver.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace orderservice {
+
+// Ограничивает прием заказов по backlog outbox: глубине очереди и возрасту самой старой
+// необработанной записи (значения снимает outbox::Archiver). Пороги, время ожидания в очереди
+// и Retry-After берутся из динамического конфига ORDERSERVICE_ADMISSION_*.
+// При перегрузке запрос ждет разгрузки не дольше queue-timeout, затем получает отказ
+class AdmissionControl final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "admission-control";
+
+    struct Decision {
+        bool admitted{true};
+        // Через сколько секунд клиенту стоит повторить запрос, если admitted == false
+        std::int64_t retry_after_seconds{0};
+    };
+
+    AdmissionControl(const components::ComponentConfig& config,
+                     const components::ComponentContext& component_context);
+
+    ~AdmissionControl() final;
+
+    // Решение для нового заказа; при перегрузке может ждать в очереди
+    Decision Admit();
+
+    // Мгновенная проверка без ожидания, для шлюза
+    Decision Check() const;
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    bool IsOverloaded() const;
+
+    const std::size_t max_queued_;
+    const std::chrono::milliseconds queue_check_interval_;
+
+    dynamic_config::Source config_source_;
+    const outbox::Archiver& archiver_;
+
+    std::atomic<std::size_t> queued_{0};
+
+    utils::statistics::RateCounter admitted_;
+    utils::statistics::RateCounter queued_total_;
+    utils::statistics::RateCounter rejected_;
+    utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace orderservice
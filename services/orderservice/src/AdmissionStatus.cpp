@@ -0,0 +1,29 @@
+#include <AdmissionStatus.hpp>
+
+#include <string>
+
+namespace orderservice {
+
+AdmissionStatus::AdmissionStatus(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      admission_control_(component_context.FindComponent<AdmissionControl>()) {}
+
+std::string AdmissionStatus::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    const auto decision = admission_control_.Check();
+
+    if (!decision.admitted) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        request.GetHttpResponse().SetHeader(std::string{"Retry-After"}, std::to_string(decision.retry_after_seconds));
+        return "";
+    }
+
+    request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
+    return "";
+}
+
+}  // namespace orderservice
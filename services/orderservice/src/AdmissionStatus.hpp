@@ -0,0 +1,25 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <AdmissionControl.hpp>
+
+namespace orderservice {
+
+// Состояние admission control для шлюза (nginx auth_request):
+// 204 - заказы принимаются, 403 с Retry-After - перегрузка, nginx отвечает клиенту 429
+class AdmissionStatus final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-admission-status";
+
+    AdmissionStatus(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+private:
+    const AdmissionControl& admission_control_;
+};
+
+}  // namespace orderservice
@@ -0,0 +1,60 @@
+#include <BestSellers.hpp>
+
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+
+namespace orderservice {
+
+namespace {
+
+constexpr std::size_t kDefaultLimit = 10;
+constexpr std::size_t kMaxLimit = 1000;
+
+}  // namespace
+
+BestSellers::BestSellers(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      sales_ranking_(component_context.FindComponent<SalesRanking>()) {}
+
+std::string BestSellers::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    try {
+        std::size_t limit = kDefaultLimit;
+        if (request.HasArg("limit")) {
+            limit = std::min<std::size_t>(std::stoul(request.GetArg("limit")), kMaxLimit);
+        }
+
+        // window=recent - продажи за скользящее окно, иначе за все время
+        const auto window = request.GetArg("window") == "recent" ? SalesRanking::Window::kRecent
+                                                                 : SalesRanking::Window::kAllTime;
+
+        userver::formats::json::ValueBuilder articles_json(userver::formats::json::Type::kArray);
+        for (const auto& entry : sales_ranking_.GetTop(window, limit)) {
+            userver::formats::json::ValueBuilder item;
+            item["article"] = entry.article;
+            item["units"] = entry.units;
+            articles_json.PushBack(std::move(item));
+        }
+
+        userver::formats::json::ValueBuilder response_json;
+        response_json["articles"] = articles_json;
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response_json.ExtractValue());
+
+    } catch (const std::logic_error& ex) {
+        // std::stoul бросает invalid_argument / out_of_range
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"field": "limit", "error": "Invalid limit"})";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while fetching best sellers: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error": "Internal server error"})";
+    }
+}
+
+}  // namespace orderservice
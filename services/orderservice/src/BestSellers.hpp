@@ -0,0 +1,23 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <SalesRanking.hpp>
+
+namespace orderservice {
+
+class BestSellers final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-best-sellers";
+
+    BestSellers(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+private:
+    SalesRanking& sales_ranking_;
+};
+
+}  // namespace orderservice
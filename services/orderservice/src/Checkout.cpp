@@ -0,0 +1,85 @@
+#include <Checkout.hpp>
+
+#include <userver/clients/http/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <CheckoutWorker.hpp>
+
+namespace orderservice {
+
+Checkout::Checkout(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()),
+      admission_control_(component_context.FindComponent<AdmissionControl>()) {}
+
+std::string Checkout::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    const auto auth_header = request.GetHeader("Authorization");
+    if (auth_header.empty()) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kUnauthorized);
+        return "";
+    }
+
+    // Пока outbox не разобран, новые заказы не принимаем: клиент повторит после Retry-After
+    const auto admission = admission_control_.Admit();
+    if (!admission.admitted) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kTooManyRequests);
+        request.GetHttpResponse().SetHeader(std::string{"Retry-After"}, std::to_string(admission.retry_after_seconds));
+        return R"({"error": "Too many orders in progress, retry later"})";
+    }
+
+    try {
+        // Проверяем JWT токен через authservice
+        auto auth_response = http_client_.CreateRequest()
+            .get()
+            .url("http://authservice:8080/verify/")
+            .headers({{"Authorization", auth_header}})
+            .timeout(std::chrono::seconds(2))
+            .perform();
+
+        if (auth_response->status_code() != 200) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+            return "";
+        }
+
+        const auto json_body = userver::formats::json::FromString(auth_response->body());
+        const auto user_id = json_body["user_id"].As<int>();
+
+        // Резервируем id заказа из последовательности orders, сохраняем задачу и будим CheckoutWorker.
+        // Все в одном запросе, уведомление придет только после коммита
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "WITH reserved AS ("
+            "    SELECT nextval('orderserviceschema.orders_id_seq')::int AS order_id"
+            "), job AS ("
+            "    INSERT INTO checkout_outbox (user_id, payload) "
+            "    SELECT $1, jsonb_build_object('order_id', order_id) FROM reserved RETURNING id"
+            "), checkout AS ("
+            "    INSERT INTO checkouts (order_id, user_id, checkout_outbox_id) "
+            "    SELECT reserved.order_id, $1, job.id FROM reserved, job RETURNING order_id"
+            ") "
+            "SELECT checkout.order_id, pg_notify($2, job.id::text) FROM checkout, job",
+            user_id,
+            std::string{CheckoutWorker::kNotifyChannel}
+        );
+
+        userver::formats::json::ValueBuilder response;
+        response["order_id"] = result[0]["order_id"].As<int>();
+
+        request.SetResponseStatus(userver::server::http::HttpStatus::kAccepted);
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response.ExtractValue());
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while accepting checkout: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error": "Internal server error"})";
+    }
+}
+
+}  // namespace orderservice
@@ -0,0 +1,103 @@
+#include <CheckoutStatus.hpp>
+
+#include <userver/clients/http/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json.hpp>
+
+#include <optional>
+
+namespace orderservice {
+
+CheckoutStatus::CheckoutStatus(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
+
+std::string CheckoutStatus::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    const auto auth_header = request.GetHeader("Authorization");
+    if (auth_header.empty()) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kUnauthorized);
+        return "";
+    }
+
+    if (!request.HasArg("order_id")) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"error":"order_id is required"})";
+    }
+
+    try {
+        // Проверяем JWT токен через authservice
+        auto auth_response = http_client_.CreateRequest()
+            .get()
+            .url("http://authservice:8080/verify/")
+            .headers({{"Authorization", auth_header}})
+            .timeout(std::chrono::seconds(2))
+            .perform();
+
+        if (auth_response->status_code() != 200) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+            return "";
+        }
+
+        const auto json_body = userver::formats::json::FromString(auth_response->body());
+        const auto user_id = json_body["user_id"].As<int>();
+        const auto order_id = std::stoi(request.GetArg("order_id"));
+
+        // Задачи в outbox нужны только чтобы отличить ожидание повтора от окончательной ошибки (DEAD)
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT c.status, c.error, o.status AS order_status, "
+            "       (checkout_job.status = 'DEAD' OR order_job.status = 'DEAD') AS failed "
+            "FROM checkouts c "
+            // Заказ создается после оформления, условие по created_at сужает поиск по секциям orders
+            "LEFT JOIN orders o ON o.id = c.order_id AND o.created_at >= c.created_at "
+            "LEFT JOIN checkout_outbox checkout_job ON checkout_job.id = c.checkout_outbox_id "
+            "LEFT JOIN outbox order_job ON order_job.id = c.outbox_id "
+            "WHERE c.order_id = $1 AND c.user_id = $2",
+            order_id, user_id
+        );
+
+        if (result.IsEmpty()) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kNotFound);
+            return R"({"error":"checkout not found"})";
+        }
+
+        const auto row = result[0];
+        const auto order_status = row["order_status"].As<std::optional<std::string>>();
+        const auto failed = row["failed"].As<std::optional<bool>>().value_or(false);
+
+        // PROCESSING -> CREATED (заказ создан, дальше статус заказа) или REJECTED / FAILED
+        userver::formats::json::ValueBuilder response;
+        response["order_id"] = order_id;
+
+        if (order_status) {
+            response["status"] = "CREATED";
+            response["order_status"] = *order_status;
+        } else if (row["status"].As<std::string>() == "REJECTED") {
+            response["status"] = "REJECTED";
+            response["error"] = row["error"].As<std::optional<std::string>>().value_or("");
+        } else if (failed) {
+            response["status"] = "FAILED";
+        } else {
+            response["status"] = "PROCESSING";
+        }
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response.ExtractValue());
+
+    } catch (const std::logic_error& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"error":"invalid order_id"})";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error in CheckoutStatus: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error":"internal error"})";
+    }
+}
+
+}  // namespace orderservice
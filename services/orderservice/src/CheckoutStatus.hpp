@@ -0,0 +1,26 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <userver/clients/http/client.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+
+namespace orderservice {
+
+// Состояние асинхронного оформления по order_id, выданному /checkout
+class CheckoutStatus final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-checkout-status";
+
+    CheckoutStatus(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+private:
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    userver::clients::http::Client& http_client_;
+};
+
+}  // namespace orderservice
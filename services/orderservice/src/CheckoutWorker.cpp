@@ -0,0 +1,195 @@
+#include "CheckoutWorker.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/clients/http/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/formats/json.hpp>
+#include <userver/logging/log.hpp>
+
+#include <stdexcept>
+
+#include <internal_auth/Token.hpp>
+
+#include <OutboxWorker.hpp>
+
+namespace orderservice {
+
+namespace {
+
+// Значения по умолчанию продублированы в секции dynamic-config static_config.yaml
+const dynamic_config::Key<std::int64_t> kCheckoutBatchSize{"ORDERSERVICE_CHECKOUT_BATCH_SIZE", 10};
+const dynamic_config::Key<std::int64_t> kCheckoutPollIntervalMs{"ORDERSERVICE_CHECKOUT_POLL_INTERVAL_MS", 10000};
+
+}  // namespace
+
+outbox::DynamicConfigKeys CheckoutHandler::ConfigKeys() {
+    return {kCheckoutBatchSize, kCheckoutPollIntervalMs};
+}
+
+CheckoutHandler::CheckoutHandler(const components::ComponentConfig& config,
+                                 const components::ComponentContext& component_context)
+    : delivery_timeout_(config["delivery-timeout"].As<std::chrono::milliseconds>(std::chrono::seconds{5})),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()),
+      internal_token_(config["internal-token"].As<std::string>(""))
+{}
+
+std::optional<formats::json::Value> CheckoutHandler::Process(storages::postgres::Transaction&,
+                                                             const outbox::Record& record) {
+    return record.payload;
+}
+
+void CheckoutHandler::Deliver(const outbox::Record& record, const formats::json::Value& message) {
+    const auto order_id = message["order_id"].As<int>();
+
+    auto checkout = pg_cluster_->Execute(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        "SELECT status, items FROM checkouts WHERE order_id = $1",
+        order_id
+    );
+
+    if (checkout.IsEmpty()) {
+        throw std::runtime_error("checkout " + std::to_string(order_id) + " not found");
+    }
+
+    const auto status = checkout[0]["status"].As<std::string>();
+
+    std::optional<formats::json::Value> items;
+    if (status == "ACCEPTED") {
+        items = PlaceOrder(order_id, record.user_id);
+    } else if (status == "ORDERED") {
+        // Заказ уже передан в outbox, прошлая попытка не дошла до очистки корзины
+        items = checkout[0]["items"].As<formats::json::Value>();
+    }
+
+    if (items) {
+        RemoveOrderedItems(order_id, record.user_id, *items);
+    }
+}
+
+std::optional<formats::json::Value> CheckoutHandler::PlaceOrder(int order_id, int user_id) {
+    // Оформления пользователя доставляются параллельно, а корзину читают целиком: без
+    // сериализации двойное нажатие создало бы два заказа из одной корзины. Блокировка держится
+    // до коммита, поэтому транзакция открыта и на время запроса в cartservice
+    auto transaction = pg_cluster_->Begin(
+        userver::storages::postgres::ClusterHostType::kMaster,
+        userver::storages::postgres::TransactionOptions{}
+    );
+
+    transaction.Execute(
+        "SELECT pg_advisory_xact_lock(hashtext('orderservice_checkout'), $1)",
+        user_id
+    );
+
+    auto state = transaction.Execute(
+        "SELECT c.status, EXISTS ("
+        "    SELECT 1 FROM checkouts other "
+        "    JOIN checkout_outbox job ON job.id = other.checkout_outbox_id "
+        "    WHERE other.user_id = $2 AND other.order_id <> $1 AND other.status = 'ORDERED' "
+        "      AND job.status NOT IN ('DONE', 'DEAD')"
+        ") AS cart_busy "
+        "FROM checkouts c WHERE c.order_id = $1",
+        order_id, user_id
+    );
+
+    if (state.IsEmpty() || state[0]["status"].As<std::string>() != "ACCEPTED") {
+        // Оформление уже перевели в другое состояние, заказ второй раз не создаем
+        transaction.Rollback();
+        return std::nullopt;
+    }
+
+    if (state[0]["cart_busy"].As<bool>()) {
+        // Товары предыдущего заказа еще не убраны из корзины: повторим после них,
+        // иначе прочитаем их второй раз
+        transaction.Rollback();
+        throw std::runtime_error("previous checkout of user " + std::to_string(user_id) + " is not finished");
+    }
+
+    userver::formats::json::ValueBuilder cart_request;
+    cart_request["userId"] = user_id;
+
+    auto cart_response = http_client_.CreateRequest()
+        .post()
+        .url("http://cartservice:8080/checkout-cart")
+        .headers({{std::string{internal_auth::kHeader}, internal_token_}})
+        .data(userver::formats::json::ToString(cart_request.ExtractValue()))
+        .timeout(delivery_timeout_)
+        .perform();
+
+    // 409 - окончательный отказ: пустая корзина или товары без цены
+    if (cart_response->status_code() == 409) {
+        const auto error = userver::formats::json::FromString(cart_response->body())["error"]
+            .As<std::string>("Cart cannot be ordered");
+
+        transaction.Execute(
+            "UPDATE checkouts SET status = 'REJECTED', error = $2, updated_at = now() "
+            "WHERE order_id = $1 AND status = 'ACCEPTED'",
+            order_id, error
+        );
+        transaction.Commit();
+
+        LOG_INFO() << "Checkout " << order_id << " rejected: " << error;
+        return std::nullopt;
+    }
+
+    if (cart_response->status_code() != 200) {
+        throw std::runtime_error("cartservice returned status " + std::to_string(cart_response->status_code()));
+    }
+
+    const auto items = userver::formats::json::FromString(cart_response->body())["cartItems"];
+
+    userver::formats::json::ValueBuilder order_payload;
+    order_payload["order_id"] = order_id;
+    order_payload["cart_items"] = items;
+
+    transaction.Execute(
+        "UPDATE checkouts SET status = 'ORDERED', items = $2::jsonb, updated_at = now() "
+        "WHERE order_id = $1",
+        order_id, items
+    );
+
+    // Заказ создаст OutboxWorker с уже выданным клиенту order_id
+    auto job = transaction.Execute(
+        "WITH inserted AS ("
+        "    INSERT INTO outbox (user_id, payload) VALUES ($1, $2::jsonb) RETURNING id"
+        ") "
+        "SELECT id, pg_notify($3, id::text) FROM inserted",
+        user_id,
+        order_payload.ExtractValue(),
+        std::string{OutboxWorker::kNotifyChannel}
+    );
+
+    transaction.Execute(
+        "UPDATE checkouts SET outbox_id = $2 WHERE order_id = $1",
+        order_id, job[0]["id"].As<int>()
+    );
+
+    transaction.Commit();
+
+    return items;
+}
+
+void CheckoutHandler::RemoveOrderedItems(int order_id, int user_id, const formats::json::Value& items) {
+    userver::formats::json::ValueBuilder remove_request;
+    remove_request["userId"] = user_id;
+    remove_request["orderId"] = order_id;
+    remove_request["items"] = items;
+
+    // cartservice запоминает order_id, повторный запрос корзину не меняет
+    auto response = http_client_.CreateRequest()
+        .post()
+        .url("http://cartservice:8080/remove-ordered-items")
+        .headers({{std::string{internal_auth::kHeader}, internal_token_}})
+        .data(userver::formats::json::ToString(remove_request.ExtractValue()))
+        .timeout(delivery_timeout_)
+        .perform();
+
+    if (response->status_code() != 204) {
+        throw std::runtime_error("cartservice returned status " + std::to_string(response->status_code()));
+    }
+
+    LOG_INFO() << "Checkout " << order_id << " placed";
+}
+
+}  // namespace orderservice
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/clients/http/client.hpp>
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <outbox/Consumer.hpp>
+
+#include <chrono>
+#include <string>
+
+
+namespace orderservice {
+
+// Обработчик задач асинхронного оформления (checkout_outbox): читает корзину в cartservice,
+// создает запись в outbox заказов с зарезервированным order_id и убирает товары из корзины.
+// Доставка at-least-once, каждый шаг можно безопасно повторить. Оформления одного пользователя
+// сериализуются: корзина читается, только когда товары предыдущего заказа уже убраны из нее
+class CheckoutHandler final {
+public:
+    static constexpr std::string_view kName = "checkout-worker";
+    static constexpr std::string_view kTable = "checkout_outbox";
+
+    // Канал, в который Checkout отправляет pg_notify вместе со вставкой в checkout_outbox
+    static constexpr std::string_view kNotifyChannel = "orderservice_checkout";
+
+    static outbox::DynamicConfigKeys ConfigKeys();
+
+    CheckoutHandler(const components::ComponentConfig& config,
+                    const components::ComponentContext& component_context);
+
+    // Вся работа идет с внешними сервисами, поэтому задача сразу уходит в доставку
+    std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                const outbox::Record& record);
+
+    void Deliver(const outbox::Record& record, const formats::json::Value& message);
+
+    void OnCommitted(const std::vector<outbox::Record>&) {}
+
+private:
+    // Читает корзину и переводит оформление в ORDERED или REJECTED; возвращает товары заказа,
+    // если заказ будет создан
+    std::optional<formats::json::Value> PlaceOrder(int order_id, int user_id);
+
+    void RemoveOrderedItems(int order_id, int user_id, const formats::json::Value& items);
+
+    const std::chrono::milliseconds delivery_timeout_;
+    storages::postgres::ClusterPtr pg_cluster_;
+    userver::clients::http::Client& http_client_;
+    // Ручки корзины служебные, токен передается в заголовке X-Internal-Token
+    const std::string internal_token_;
+};
+
+using CheckoutWorker = outbox::Consumer<CheckoutHandler>;
+
+}  // namespace orderservice
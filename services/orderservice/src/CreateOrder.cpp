@@ -3,6 +3,8 @@
 #include <userver/clients/http/component.hpp>
 #include <userver/storages/postgres/component.hpp>
 
+#include <OutboxWorker.hpp>
+
 namespace orderservice {
 
 CreateOrder::CreateOrder(
@@ -11,7 +13,8 @@ CreateOrder::CreateOrder(
 )
     : HttpHandlerBase(config, component_context),
       pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
-      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()),
+      admission_control_(component_context.FindComponent<AdmissionControl>()) {}
 
 std::string CreateOrder::
     HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
@@ -22,6 +25,14 @@ std::string CreateOrder::
         return "";
     }
 
+    // Пока outbox не разобран, новые заказы не принимаем: клиент повторит после Retry-After
+    const auto admission = admission_control_.Admit();
+    if (!admission.admitted) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kTooManyRequests);
+        request.GetHttpResponse().SetHeader(std::string{"Retry-After"}, std::to_string(admission.retry_after_seconds));
+        return R"({"error": "Too many orders in progress, retry later"})";
+    }
+
     try {
         // Проверяем JWT токен через authservice
         auto auth_response = http_client_.CreateRequest()
@@ -55,12 +66,17 @@ std::string CreateOrder::
             total_amount += item["price"].As<double>() * item["quantity"].As<int>();
         }
 
-        // сохраняем в outbox
+        // сохраняем в outbox и будим OutboxWorker. Запрос выполняется в одной транзакции,
+        // так что уведомление придет только после коммита вставки
         pg_cluster_->Execute(
             userver::storages::postgres::ClusterHostType::kMaster,
-            "INSERT INTO outbox (user_id, payload) VALUES ($1, $2::jsonb)",
+            "WITH inserted AS ("
+            "    INSERT INTO outbox (user_id, payload) VALUES ($1, $2::jsonb) RETURNING id"
+            ") "
+            "SELECT pg_notify($3, id::text) FROM inserted",
             user_id,
-            body_json
+            body_json,
+            std::string{OutboxWorker::kNotifyChannel}
         );
 
         request.SetResponseStatus(userver::server::http::HttpStatus::kNoContent);
@@ -6,6 +6,8 @@
 #include <userver/clients/http/client.hpp>
 #include <userver/storages/postgres/cluster.hpp>
 
+#include <AdmissionControl.hpp>
+
 namespace orderservice {
 
 class CreateOrder final : public userver::server::handlers::HttpHandlerBase {
@@ -20,6 +22,7 @@ public:
 private:
     userver::storages::postgres::ClusterPtr pg_cluster_;
     userver::clients::http::Client& http_client_;
+    AdmissionControl& admission_control_;
 };
 
 }  // namespace orderservice
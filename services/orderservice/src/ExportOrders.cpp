@@ -0,0 +1,248 @@
+#include <ExportOrders.hpp>
+
+#include <userver/components/statistics_storage.hpp>
+#include <userver/engine/deadline.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
+#include <userver/utils/datetime.hpp>
+#include <userver/utils/statistics/writer.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+#include <optional>
+
+namespace orderservice {
+
+namespace {
+
+// Один заказ - одна строка JSON; товары берутся из секции order_items того же месяца.
+// Без ORDER BY: секции читаются по порядку месяцев, сортировка всей таблицы не нужна.
+// Диапазон from/to отсекает секции orders и order_items
+const std::string kSelectOrdersNdjson =
+    "SELECT jsonb_build_object("
+    "    'order_id', o.id, 'user_id', o.user_id, 'total_amount', o.total_amount::float8, "
+    "    'status', o.status, "
+    "    'created_at', to_char(o.created_at, 'YYYY-MM-DD\"T\"HH24:MI:SS.US\"+0000\"'), "
+    "    'items', COALESCE(("
+    "        SELECT jsonb_agg(jsonb_build_object("
+    "            'article', oi.article, 'quantity', oi.quantity, 'price', oi.price::float8"
+    "        ))"
+    "        FROM orderserviceschema.order_items oi WHERE oi.order_id = o.id AND oi.created_at = o.created_at"
+    "    ), '[]'::jsonb)"
+    ")::text AS line "
+    "FROM orderserviceschema.orders o "
+    "WHERE o.created_at >= COALESCE($1::timestamptz, '-infinity') "
+    "AND o.created_at < COALESCE($2::timestamptz, 'infinity')";
+
+const std::string kSelectOrdersCsv =
+    "SELECT o.id, o.user_id, o.status, o.total_amount::text AS total_amount, "
+    "to_char(o.created_at, 'YYYY-MM-DD\"T\"HH24:MI:SS.US\"+0000\"') AS created_at, "
+    "oi.article, oi.quantity, oi.price::text AS price "
+    "FROM orderserviceschema.orders o "
+    "JOIN orderserviceschema.order_items oi ON oi.order_id = o.id AND oi.created_at = o.created_at "
+    "WHERE o.created_at >= COALESCE($1::timestamptz, '-infinity') "
+    "AND o.created_at < COALESCE($2::timestamptz, 'infinity')";
+
+constexpr std::string_view kCsvHeader = "order_id,user_id,status,total_amount,created_at,article,quantity,price\n";
+
+// Поле CSV по RFC 4180: в кавычки, если есть разделитель, кавычка или перевод строки
+void AppendCsvField(std::string& out, const std::string& value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (const char c : value) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+std::optional<userver::storages::postgres::TimePointTz> ParseBound(
+    const userver::server::http::HttpRequest& request, const std::string& name) {
+    if (!request.HasArg(name)) {
+        return std::nullopt;
+    }
+    return userver::storages::postgres::TimePointTz{userver::utils::datetime::Stringtime(request.GetArg(name))};
+}
+
+}  // namespace
+
+ExportOrders::ExportOrders(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      batch_size_(config["batch-size"].As<std::uint32_t>(500)),
+      chunk_size_(config["chunk-size"].As<std::size_t>(64 * 1024)),
+      chunk_timeout_(config["chunk-timeout"].As<std::chrono::milliseconds>(std::chrono::seconds{30})),
+      internal_token_(config["internal-token"].As<std::string>("")),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster())
+{
+    auto& storage = component_context.FindComponent<userver::components::StatisticsStorage>().GetStorage();
+    statistics_holder_ = storage.RegisterWriter("orders-export", [this](userver::utils::statistics::Writer& writer) {
+        writer["rows"] = rows_sent_.Load();
+        writer["bytes"] = bytes_sent_.Load();
+        writer["failures"] = failures_.Load();
+        writer["in-progress"] = in_progress_.load();
+    });
+}
+
+ExportOrders::~ExportOrders() {
+    statistics_holder_.Unregister();
+}
+
+std::string ExportOrders::HandleRequestThrow(
+    const userver::server::http::HttpRequest&,
+    userver::server::request::RequestContext&
+) const {
+    return "";
+}
+
+void ExportOrders::HandleStreamRequest(
+    userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&,
+    userver::server::http::ResponseBodyStream& response_body_stream
+) const {
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        response_body_stream.SetStatusCode(userver::server::http::HttpStatus::kForbidden);
+        response_body_stream.SetEndOfHeaders();
+        response_body_stream.PushBodyChunk(R"({"error":"forbidden"})",
+                                           userver::engine::Deadline::FromDuration(chunk_timeout_));
+        return;
+    }
+
+    const auto format = request.HasArg("format") ? request.GetArg("format") : std::string{"ndjson"};
+    const bool csv = format == "csv";
+
+    std::optional<userver::storages::postgres::TimePointTz> from;
+    std::optional<userver::storages::postgres::TimePointTz> to;
+    try {
+        from = ParseBound(request, "from");
+        to = ParseBound(request, "to");
+    } catch (const std::exception& ex) {
+        response_body_stream.SetStatusCode(userver::server::http::HttpStatus::kBadRequest);
+        response_body_stream.SetEndOfHeaders();
+        response_body_stream.PushBodyChunk(R"({"error":"invalid from or to"})",
+                                           userver::engine::Deadline::FromDuration(chunk_timeout_));
+        return;
+    }
+
+    if (!csv && format != "ndjson") {
+        response_body_stream.SetStatusCode(userver::server::http::HttpStatus::kBadRequest);
+        response_body_stream.SetEndOfHeaders();
+        response_body_stream.PushBodyChunk(R"({"error":"format must be ndjson or csv"})",
+                                           userver::engine::Deadline::FromDuration(chunk_timeout_));
+        return;
+    }
+
+    ++in_progress_;
+
+    try {
+        // Серверный курсор (portal) живет только внутри транзакции; выгрузка читает реплику
+        auto transaction = pg_cluster_->Begin(
+            "export_orders",
+            userver::storages::postgres::ClusterHostType::kSlave,
+            userver::storages::postgres::TransactionOptions{userver::storages::postgres::TransactionOptions::kReadOnly}
+        );
+
+        auto portal = transaction.MakePortal(csv ? kSelectOrdersCsv : kSelectOrdersNdjson, from, to);
+
+        response_body_stream.SetStatusCode(userver::server::http::HttpStatus::kOk);
+        response_body_stream.SetHeader(std::string_view{"Content-Type"},
+                                       csv ? "text/csv; charset=utf-8" : "application/x-ndjson");
+        response_body_stream.SetEndOfHeaders();
+
+        std::string chunk;
+        chunk.reserve(chunk_size_);
+        if (csv) {
+            chunk += kCsvHeader;
+        }
+
+        const auto flush = [&] {
+            if (chunk.empty()) {
+                return;
+            }
+            bytes_sent_.Add(userver::utils::statistics::Rate{chunk.size()});
+            response_body_stream.PushBodyChunk(std::move(chunk), userver::engine::Deadline::FromDuration(chunk_timeout_));
+            chunk = std::string{};
+            chunk.reserve(chunk_size_);
+        };
+
+        while (portal) {
+            const auto batch = portal.Fetch(batch_size_);
+
+            for (const auto& row : batch) {
+                if (csv) {
+                    chunk += std::to_string(row["id"].As<int>());
+                    chunk += ',';
+                    chunk += std::to_string(row["user_id"].As<int>());
+                    chunk += ',';
+                    AppendCsvField(chunk, row["status"].As<std::string>());
+                    chunk += ',';
+                    chunk += row["total_amount"].As<std::string>();
+                    chunk += ',';
+                    chunk += row["created_at"].As<std::string>();
+                    chunk += ',';
+                    AppendCsvField(chunk, row["article"].As<std::string>());
+                    chunk += ',';
+                    chunk += std::to_string(row["quantity"].As<int>());
+                    chunk += ',';
+                    chunk += row["price"].As<std::string>();
+                } else {
+                    chunk += row["line"].As<std::string>();
+                }
+                chunk += '\n';
+
+                if (chunk.size() >= chunk_size_) {
+                    flush();
+                }
+            }
+
+            rows_sent_.Add(userver::utils::statistics::Rate{batch.Size()});
+        }
+
+        flush();
+        transaction.Commit();
+
+    } catch (const std::exception& ex) {
+        // Заголовки уже могли уйти клиенту: выгрузка обрывается, клиент видит неполный ответ
+        failures_.Add(userver::utils::statistics::Rate{1});
+        --in_progress_;
+        LOG_ERROR() << "Error while exporting orders: " << ex.what();
+        throw;
+    }
+
+    --in_progress_;
+}
+
+userver::yaml_config::Schema ExportOrders::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Streams all orders with their items as NDJSON or CSV
+additionalProperties: false
+properties:
+    batch-size:
+        type: integer
+        description: how many rows are fetched from the Postgres cursor at once
+        defaultDescription: 500
+    chunk-size:
+        type: integer
+        description: response body chunk size in bytes
+        defaultDescription: 65536
+    chunk-timeout:
+        type: string
+        description: how long sending one chunk to the client may take
+        defaultDescription: 30s
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace orderservice
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+#include <userver/server/http/http_response_body_stream.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+#include <userver/utils/statistics/entry.hpp>
+#include <userver/utils/statistics/rate_counter.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace orderservice {
+
+// Выгрузка всех заказов с товарами для сверки (make export-orders), только внутри сети:
+// nginx ее не проксирует, а без заголовка X-Internal-Token с internal-token ручка отвечает 403.
+// Ответ отдается чанками по мере чтения из серверного курсора Postgres пачками batch-size,
+// поэтому память не зависит от объема выгрузки.
+//   ?format=ndjson (по умолчанию) - строка JSON на заказ, товары в items
+//   ?format=csv                   - строка на товар заказа
+//   ?from=...&to=...              - необязательный диапазон created_at, ISO 8601
+class ExportOrders final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-export-orders";
+
+    ExportOrders(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    ~ExportOrders() override;
+
+    // Не вызывается: в конфиге ручки включен response-body-stream
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    void HandleStreamRequest(userver::server::http::HttpRequest&,
+                             userver::server::request::RequestContext&,
+                             userver::server::http::ResponseBodyStream&) const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    const std::uint32_t batch_size_;
+    const std::size_t chunk_size_;
+    const std::chrono::milliseconds chunk_timeout_;
+    const std::string internal_token_;
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    mutable userver::utils::statistics::RateCounter rows_sent_;
+    mutable userver::utils::statistics::RateCounter bytes_sent_;
+    mutable userver::utils::statistics::RateCounter failures_;
+    mutable std::atomic<std::int64_t> in_progress_{0};
+    userver::utils::statistics::Entry statistics_holder_;
+};
+
+}  // namespace orderservice
@@ -0,0 +1,96 @@
+#include <FetchOrderEvents.hpp>
+
+#include <userver/clients/http/component.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <optional>
+
+namespace orderservice {
+
+FetchOrderEvents::FetchOrderEvents(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      max_wait_(config["max-wait"].As<std::chrono::milliseconds>(std::chrono::seconds{25})),
+      order_events_(component_context.FindComponent<OrderEvents>()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
+
+std::string FetchOrderEvents::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&
+) const {
+    const auto auth_header = request.GetHeader("Authorization");
+    if (auth_header.empty()) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kUnauthorized);
+        return "";
+    }
+
+    try {
+        // Проверяем JWT токен через authservice
+        auto auth_response = http_client_.CreateRequest()
+            .get()
+            .url("http://authservice:8080/verify/")
+            .headers({{"Authorization", auth_header}})
+            .timeout(std::chrono::seconds(2))
+            .perform();
+
+        if (auth_response->status_code() != 200) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+            return "";
+        }
+
+        const auto json_body = userver::formats::json::FromString(auth_response->body());
+        const auto user_id = json_body["user_id"].As<int>();
+
+        // after - cursor из предыдущего ответа
+        std::optional<std::string> after;
+        if (request.HasArg("after")) {
+            after = request.GetArg("after");
+        }
+
+        const auto batch = order_events_.Wait(user_id, after, userver::engine::Deadline::FromDuration(max_wait_));
+
+        userver::formats::json::ValueBuilder response;
+        response["events"] = userver::formats::json::MakeArray();
+
+        for (const auto& event : batch.events) {
+            userver::formats::json::ValueBuilder item;
+            item["event_id"] = event.sequence;
+            item["order_id"] = event.order_id;
+            item["status"] = event.status;
+            response["events"].PushBack(item.ExtractValue());
+        }
+
+        // Клиент передает cursor в after следующего запроса; при reset сначала перечитывает заказы
+        response["cursor"] = batch.cursor;
+        response["reset"] = batch.reset;
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response.ExtractValue());
+
+    } catch (const OrderEvents::InvalidCursor& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"error":"invalid after"})";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error in FetchOrderEvents: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error":"internal error"})";
+    }
+}
+
+userver::yaml_config::Schema FetchOrderEvents::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Long-poll of order status events for the authenticated user
+additionalProperties: false
+properties:
+    max-wait:
+        type: string
+        description: how long a request waits for new events
+        defaultDescription: 25s
+)");
+}
+
+}  // namespace orderservice
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <userver/clients/http/client.hpp>
+
+#include <chrono>
+
+#include <OrderEvents.hpp>
+
+namespace orderservice {
+
+// Long-poll подписка на смену статусов заказов пользователя
+class FetchOrderEvents final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-fetch-order-events";
+
+    FetchOrderEvents(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&) const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    const std::chrono::milliseconds max_wait_;
+    OrderEvents& order_events_;
+    userver::clients::http::Client& http_client_;
+};
+
+} // namespace orderservice
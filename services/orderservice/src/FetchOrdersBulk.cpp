@@ -2,9 +2,33 @@
 
 #include <userver/clients/http/component.hpp>
 #include <userver/storages/postgres/component.hpp>
+#include <userver/utils/datetime.hpp>
+
+#include <algorithm>
+#include <optional>
 
 namespace orderservice {
 
+namespace {
+
+// Совпадает с размером документа в user_order_history
+constexpr std::size_t kDefaultLimit = 20;
+constexpr std::size_t kMaxLimit = 100;
+
+// Товары собираются подзапросом по PK order_items, поэтому страница заказов - это один запрос.
+// Условие по created_at заказа оставляет подзапросу одну секцию order_items
+const std::string kSelectOrdersPage =
+    "SELECT o.id, o.total_amount::float8, o.status, o.created_at, "
+    "COALESCE(("
+    "    SELECT jsonb_agg(jsonb_build_object("
+    "        'article', oi.article, 'quantity', oi.quantity, 'price', oi.price::float8"
+    "    ))"
+    "    FROM orderserviceschema.order_items oi WHERE oi.order_id = o.id AND oi.created_at = o.created_at"
+    "), '[]'::jsonb) AS items "
+    "FROM orderserviceschema.orders o ";
+
+}  // namespace
+
 FetchOrdersBulk::FetchOrdersBulk(
     const userver::components::ComponentConfig& config,
     const userver::components::ComponentContext& component_context
@@ -40,18 +64,71 @@ std::string FetchOrdersBulk::HandleRequestThrow(
         const auto json_body = userver::formats::json::FromString(auth_response->body());
         const auto user_id = json_body["user_id"].As<int>();
 
-        // Получаем заказы пользователя
-        auto res_orders = pg_cluster_->Execute(
-            userver::storages::postgres::ClusterHostType::kSlave,
-            "SELECT id, total_amount::float8, status, created_at "
-            "FROM orderserviceschema.orders WHERE user_id=$1 ORDER BY created_at DESC",
-            user_id
-        );
+        // Размер страницы и курсор (created_at, id) последнего заказа предыдущей страницы
+        std::size_t limit = kDefaultLimit;
+        if (request.HasArg("limit")) {
+            limit = std::clamp<std::size_t>(std::stoul(request.GetArg("limit")), 1, kMaxLimit);
+        }
+
+        const bool has_cursor = request.HasArg("before_created_at") && request.HasArg("before_id");
+
+        // Первая страница - это готовый документ из read model, одна строка с реплики
+        if (!has_cursor && limit == kDefaultLimit) {
+            auto res_history = pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kSlave,
+                "SELECT orders, next_cursor FROM orderserviceschema.user_order_history WHERE user_id = $1",
+                user_id
+            );
+
+            if (res_history.Size() > 0) {
+                userver::formats::json::ValueBuilder response_json(userver::formats::json::Type::kObject);
+                response_json["orders"] = res_history[0]["orders"].As<userver::formats::json::Value>();
+
+                const auto next_cursor =
+                    res_history[0]["next_cursor"].As<std::optional<userver::formats::json::Value>>();
+                if (next_cursor) {
+                    response_json["next_cursor"] = *next_cursor;
+                }
+
+                request.SetResponseStatus(userver::server::http::HttpStatus::kOk);
+                return userver::formats::json::ToString(response_json.ExtractValue());
+            }
+            // Документа нет (еще не было заказов или не сделан backfill) - собираем страницу запросом
+        }
+
+        // Заказы страницы вместе с их товарами одним запросом.
+        // Берем на один заказ больше, чтобы понять, есть ли следующая страница
+        userver::storages::postgres::ResultSet res_orders = has_cursor
+            ? pg_cluster_->Execute(
+                  userver::storages::postgres::ClusterHostType::kSlave,
+                  kSelectOrdersPage +
+                  // Отдельное условие на created_at нужно для отсечения секций: по сравнению строк его нет
+                  "WHERE o.user_id = $1 AND o.created_at <= $3::timestamptz "
+                  "AND (o.created_at, o.id) < ($3::timestamptz, $4) "
+                  "ORDER BY o.created_at DESC, o.id DESC LIMIT $2",
+                  user_id,
+                  static_cast<std::int64_t>(limit + 1),
+                  userver::storages::postgres::TimePointTz{
+                      userver::utils::datetime::Stringtime(request.GetArg("before_created_at"))
+                  },
+                  std::stoi(request.GetArg("before_id"))
+              )
+            : pg_cluster_->Execute(
+                  userver::storages::postgres::ClusterHostType::kSlave,
+                  kSelectOrdersPage +
+                  "WHERE o.user_id = $1 "
+                  "ORDER BY o.created_at DESC, o.id DESC LIMIT $2",
+                  user_id,
+                  static_cast<std::int64_t>(limit + 1)
+              );
 
         userver::formats::json::ValueBuilder response_json(userver::formats::json::Type::kObject);
         auto orders_array = response_json["orders"];
+        orders_array = userver::formats::json::ValueBuilder(userver::formats::json::Type::kArray);
 
-        for (const auto& row : res_orders) {
+        const auto page_size = std::min(res_orders.Size(), limit);
+        for (std::size_t i = 0; i < page_size; ++i) {
+            const auto row = res_orders[i];
             userver::formats::json::ValueBuilder order_json(userver::formats::json::Type::kObject);
 
             int order_id = row["id"].As<int>();
@@ -59,31 +136,30 @@ std::string FetchOrdersBulk::HandleRequestThrow(
             order_json["total_amount"] = row["total_amount"].As<double>();
             order_json["status"] = row["status"].As<std::string>();
             auto created_at = row["created_at"].As<userver::storages::postgres::TimePointTz>();
-            order_json["created_at"] = userver::utils::datetime::Timestring(created_at.GetUnderlying());
+            const auto created_at_string = userver::utils::datetime::Timestring(created_at.GetUnderlying());
+            order_json["created_at"] = created_at_string;
+            order_json["items"] = row["items"].As<userver::formats::json::Value>();
 
-            // Получаем items для заказа
-            auto res_items = pg_cluster_->Execute(
-                userver::storages::postgres::ClusterHostType::kSlave,
-                "SELECT article, quantity, price::float8 "
-                "FROM orderserviceschema.order_items WHERE order_id=$1",
-                order_id
-            );
+            orders_array.PushBack(order_json.ExtractValue());
 
-            auto items_array = order_json["items"];
-            for (const auto& item_row : res_items) {
-                userver::formats::json::ValueBuilder item_json(userver::formats::json::Type::kObject);
-                item_json["article"] = item_row["article"].As<std::string>();
-                item_json["quantity"] = item_row["quantity"].As<int>();
-                item_json["price"] = item_row["price"].As<double>();
-                items_array.PushBack(item_json.ExtractValue());
+            if (i + 1 == page_size && res_orders.Size() > limit) {
+                userver::formats::json::ValueBuilder cursor_json(userver::formats::json::Type::kObject);
+                cursor_json["before_created_at"] = created_at_string;
+                cursor_json["before_id"] = order_id;
+                response_json["next_cursor"] = cursor_json;
             }
-
-            orders_array.PushBack(order_json.ExtractValue());
         }
 
         request.SetResponseStatus(userver::server::http::HttpStatus::kOk);
         return userver::formats::json::ToString(response_json.ExtractValue());
 
+    } catch (const userver::utils::datetime::DateParseError& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"error": "Invalid pagination parameters"})";
+    } catch (const std::logic_error& ex) {
+        // Некорректные limit / курсор: std::stoul и std::stoi
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"error": "Invalid pagination parameters"})";
     } catch (const std::exception& ex) {
         LOG_ERROR() << "Error while fetching orders: " << ex.what();
         request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
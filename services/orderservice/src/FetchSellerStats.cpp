@@ -0,0 +1,50 @@
+#include <FetchSellerStats.hpp>
+
+#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json.hpp>
+
+namespace orderservice {
+
+FetchSellerStats::FetchSellerStats(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()) {}
+
+std::string FetchSellerStats::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    if (!request.HasArg("seller_name")) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"field": "seller_name", "error": "seller_name is required"})";
+    }
+
+    try {
+        const auto seller_name = request.GetArg("seller_name");
+
+        // Одна строка по первичному ключу, независимо от объема продаж
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kSlave,
+            "SELECT orders_count, units_sold, revenue::float8 AS revenue "
+            "FROM orderserviceschema.seller_sales_stats WHERE seller_name = $1",
+            seller_name
+        );
+
+        userver::formats::json::ValueBuilder response;
+        response["seller_name"] = seller_name;
+        response["orders_count"] = result.IsEmpty() ? 0 : result[0]["orders_count"].As<std::int64_t>();
+        response["units_sold"] = result.IsEmpty() ? 0 : result[0]["units_sold"].As<std::int64_t>();
+        response["revenue"] = result.IsEmpty() ? 0.0 : result[0]["revenue"].As<double>();
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response.ExtractValue());
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error in FetchSellerStats: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error":"internal error"})";
+    }
+}
+
+}  // namespace orderservice
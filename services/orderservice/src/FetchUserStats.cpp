@@ -0,0 +1,66 @@
+#include <FetchUserStats.hpp>
+
+#include <userver/clients/http/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/formats/json.hpp>
+
+namespace orderservice {
+
+FetchUserStats::FetchUserStats(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
+
+std::string FetchUserStats::
+    HandleRequestThrow(const userver::server::http::HttpRequest& request, userver::server::request::RequestContext&)
+        const {
+    const auto auth_header = request.GetHeader("Authorization");
+    if (auth_header.empty()) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kUnauthorized);
+        return "";
+    }
+
+    try {
+        // Проверяем JWT токен через authservice
+        auto auth_response = http_client_.CreateRequest()
+            .get()
+            .url("http://authservice:8080/verify/")
+            .headers({{"Authorization", auth_header}})
+            .timeout(std::chrono::seconds(2))
+            .perform();
+
+        if (auth_response->status_code() != 200) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+            return "";
+        }
+
+        const auto json_body = userver::formats::json::FromString(auth_response->body());
+        const auto user_id = json_body["user_id"].As<int>();
+
+        // Одна строка по первичному ключу, независимо от размера истории
+        auto result = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kSlave,
+            "SELECT orders_count, paid_orders_count, total_spent::float8 AS total_spent "
+            "FROM orderserviceschema.user_order_stats WHERE user_id = $1",
+            user_id
+        );
+
+        userver::formats::json::ValueBuilder response;
+        response["orders_count"] = result.IsEmpty() ? 0 : result[0]["orders_count"].As<std::int64_t>();
+        response["paid_orders_count"] = result.IsEmpty() ? 0 : result[0]["paid_orders_count"].As<std::int64_t>();
+        response["total_spent"] = result.IsEmpty() ? 0.0 : result[0]["total_spent"].As<double>();
+
+        request.GetHttpResponse().SetContentType("application/json");
+        return userver::formats::json::ToString(response.ExtractValue());
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error in FetchUserStats: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error":"internal error"})";
+    }
+}
+
+}  // namespace orderservice
@@ -0,0 +1,221 @@
+#include "OrderEvents.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <userver/engine/sleep.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/exceptions.hpp>
+#include <userver/utils/async.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+namespace orderservice {
+
+namespace {
+
+constexpr auto kReconnectDelay = std::chrono::seconds{1};
+// Ожидание уведомления ограничено, чтобы периодически проверять отмену задачи
+constexpr auto kWaitNotifyTimeout = std::chrono::seconds{30};
+
+std::int64_t NewEpoch() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+std::string FormatCursor(std::int64_t epoch, std::int64_t sequence) {
+    return std::to_string(epoch) + "-" + std::to_string(sequence);
+}
+
+}  // namespace
+
+OrderEvents::OrderEvents(const components::ComponentConfig& config,
+                         const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      buffer_size_(config["buffer-size"].As<std::size_t>(32)),
+      idle_ttl_(config["idle-ttl"].As<std::chrono::milliseconds>(std::chrono::minutes{5})),
+      epoch_(NewEpoch()),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster())
+{
+    utils::PeriodicTask::Settings settings{idle_ttl_};
+    cleanup_task_.Start("order-events-cleanup", settings, [this] { RemoveIdleChannels(); });
+
+    listen_task_ = utils::CriticalAsync("order-events-listen", [this] { Listen(); });
+}
+
+OrderEvents::~OrderEvents() {
+    listen_task_.SyncCancel();
+    cleanup_task_.Stop();
+}
+
+OrderEvents::Batch OrderEvents::Wait(int user_id,
+                                     const std::optional<std::string>& after,
+                                     engine::Deadline deadline) {
+    std::optional<std::int64_t> after_epoch;
+    std::int64_t after_sequence = 0;
+    if (after) {
+        const auto dash = after->find('-');
+        if (dash == std::string::npos) {
+            throw InvalidCursor("cursor must be <epoch>-<sequence>");
+        }
+        try {
+            after_epoch = std::stoll(after->substr(0, dash));
+            after_sequence = std::stoll(after->substr(dash + 1));
+        } catch (const std::logic_error&) {
+            throw InvalidCursor("cursor must be <epoch>-<sequence>");
+        }
+    }
+
+    const auto channel = GetChannel(user_id);
+
+    std::unique_lock lock(channel->mutex);
+    channel->last_activity = std::chrono::steady_clock::now();
+
+    const auto epoch = epoch_.load();
+
+    if (!after) {
+        after_sequence = last_sequence_.load();
+    } else if (*after_epoch != epoch || after_sequence < channel->lost_up_to) {
+        return Batch{{}, FormatCursor(epoch, last_sequence_.load()), true};
+    }
+
+    const auto cursor = after_sequence;
+    const auto has_new = [&channel, cursor] {
+        return std::any_of(channel->events.begin(), channel->events.end(),
+                           [cursor](const Event& event) { return event.sequence > cursor; });
+    };
+
+    channel->cv.WaitUntil(lock, deadline, has_new);
+    channel->last_activity = std::chrono::steady_clock::now();
+
+    // Пока ждали, могли переподключиться к каналу: события между эпохами не гарантированы
+    if (epoch_.load() != epoch) {
+        return Batch{{}, FormatCursor(epoch_.load(), last_sequence_.load()), true};
+    }
+
+    Batch result{{}, FormatCursor(epoch, cursor), false};
+    for (const auto& event : channel->events) {
+        if (event.sequence > cursor) {
+            result.events.push_back(event);
+            result.cursor = FormatCursor(epoch, event.sequence);
+        }
+    }
+    return result;
+}
+
+void OrderEvents::Publish(int user_id, int order_id, std::string status) {
+    const auto channel = GetChannel(user_id);
+
+    {
+        std::lock_guard lock(channel->mutex);
+        // Publish вызывает только задача Listen, поэтому номера в канале идут по возрастанию
+        const auto sequence = ++last_sequence_;
+        channel->events.push_back(Event{sequence, order_id, std::move(status)});
+        while (channel->events.size() > buffer_size_) {
+            channel->lost_up_to = channel->events.front().sequence;
+            channel->events.pop_front();
+        }
+        channel->last_activity = std::chrono::steady_clock::now();
+    }
+
+    channel->cv.NotifyAll();
+}
+
+std::shared_ptr<OrderEvents::Channel> OrderEvents::GetChannel(int user_id) {
+    std::lock_guard lock(channels_mutex_);
+
+    auto& channel = channels_[user_id];
+    if (!channel) {
+        channel = std::make_shared<Channel>();
+        // События до создания канала (в том числе из удаленного простаивающего канала) не сохранены
+        channel->lost_up_to = last_sequence_.load();
+        channel->last_activity = std::chrono::steady_clock::now();
+    }
+    return channel;
+}
+
+void OrderEvents::Listen() {
+    bool reconnect = false;
+
+    while (!engine::current_task::ShouldCancel()) {
+        try {
+            auto notify_scope = pg_cluster_->Listen(kNotifyChannel);
+            if (reconnect) {
+                // Эпоха меняется, когда подписка уже восстановлена: курсоры новой эпохи
+                // не пропускают уведомлений
+                epoch_ = NewEpoch();
+                reconnect = false;
+            }
+
+            while (!engine::current_task::ShouldCancel()) {
+                try {
+                    const auto notification = notify_scope.WaitNotify(
+                        engine::Deadline::FromDuration(kWaitNotifyTimeout)
+                    );
+                    if (!notification.payload) {
+                        continue;
+                    }
+
+                    const auto json = userver::formats::json::FromString(*notification.payload);
+                    Publish(
+                        json["user_id"].As<int>(),
+                        json["order_id"].As<int>(),
+                        json["status"].As<std::string>()
+                    );
+                } catch (const userver::storages::postgres::ConnectionTimeout&) {
+                    // Событий не было
+                } catch (const userver::formats::json::Exception& ex) {
+                    LOG_ERROR() << "Malformed order event: " << ex.what();
+                }
+            }
+        } catch (const std::exception& ex) {
+            if (engine::current_task::ShouldCancel()) {
+                break;
+            }
+            // Уведомления до переподключения потеряны: новая эпоха заставит
+            // клиентов со старыми курсорами перечитать заказы
+            LOG_ERROR() << "Error in OrderEvents listen loop: " << ex.what();
+            engine::InterruptibleSleepFor(kReconnectDelay);
+            reconnect = true;
+        }
+    }
+}
+
+void OrderEvents::RemoveIdleChannels() {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard lock(channels_mutex_);
+    for (auto it = channels_.begin(); it != channels_.end();) {
+        // Ссылки на канал берутся только под channels_mutex_, поэтому единственная ссылка
+        // означает, что канал сейчас никто не ждет и в него никто не пишет
+        const auto& channel = it->second;
+        if (channel.use_count() == 1 && now - channel->last_activity > idle_ttl_) {
+            it = channels_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+yaml_config::Schema OrderEvents::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: Per-user registry of order status events for /order-events subscribers
+additionalProperties: false
+properties:
+    buffer-size:
+        type: integer
+        description: how many recent events are kept per user
+        defaultDescription: 32
+    idle-ttl:
+        type: string
+        description: how long a user without subscribers and events is kept in memory
+        defaultDescription: 5m
+)");
+}
+
+}  // namespace orderservice
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/engine/condition_variable.hpp>
+#include <userver/engine/deadline.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace orderservice {
+
+// Реестр подписчиков на смену статусов заказов, по пользователям.
+// PaymentResult отправляет событие через pg_notify в своей транзакции, каждая реплика
+// слушает канал и раздает событие ожидающим запросам /order-events своего процесса.
+// На пользователя хранится buffer-size последних событий, чтобы между long-poll запросами
+// клиента ничего не терялось.
+//
+// Порядок событий задает сам процесс: уведомления приходят в порядке коммитов, и Publish
+// нумерует их по порядку получения. Курсор клиента - "<epoch>-<sequence>", где epoch
+// меняется при старте процесса и после переподключения к каналу. Если по курсору нельзя
+// гарантировать, что клиент видел все события (курсор другой реплики или эпохи, события
+// после курсора вытеснены из буфера), Wait сразу возвращает reset: клиент перечитывает
+// заказы и продолжает с нового курсора
+class OrderEvents final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "order-events";
+
+    // Канал, в который PaymentResult отправляет события
+    static constexpr std::string_view kNotifyChannel = "orderservice_order_events";
+
+    struct Event {
+        // Номер в порядке получения уведомлений этим процессом, задает Publish
+        std::int64_t sequence{0};
+        int order_id{0};
+        std::string status;
+    };
+
+    struct Batch {
+        std::vector<Event> events;
+        // Курсор, который клиент передает в after следующего запроса
+        std::string cursor;
+        // События между after и cursor могли потеряться, клиенту нужно перечитать заказы
+        bool reset{false};
+    };
+
+    // Курсор after не разбирается
+    class InvalidCursor final : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    OrderEvents(const components::ComponentConfig& config,
+                const components::ComponentContext& component_context);
+
+    ~OrderEvents() final;
+
+    // События пользователя новее after; если их нет - ждет до deadline.
+    // Без after отдает только события, пришедшие после вызова
+    Batch Wait(int user_id, const std::optional<std::string>& after, engine::Deadline deadline);
+
+    // Нумерует событие и раздает его подписчикам этого процесса
+    void Publish(int user_id, int order_id, std::string status);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    struct Channel {
+        engine::Mutex mutex;
+        engine::ConditionVariable cv;
+        std::deque<Event> events;
+        // Курсоры не новее этого номера не покрывают все события канала: события вытеснены
+        // из буфера или пришли до создания канала
+        std::int64_t lost_up_to{0};
+        std::chrono::steady_clock::time_point last_activity;
+    };
+
+    std::shared_ptr<Channel> GetChannel(int user_id);
+    void Listen();
+    void RemoveIdleChannels();
+
+    const std::size_t buffer_size_;
+    const std::chrono::milliseconds idle_ttl_;
+
+    engine::Mutex channels_mutex_;
+    std::unordered_map<int, std::shared_ptr<Channel>> channels_;
+
+    // Номер последнего полученного события; меняется только задачей Listen
+    std::atomic<std::int64_t> last_sequence_{0};
+    // Эпоха курсоров: время старта или последнего переподключения к каналу в микросекундах
+    std::atomic<std::int64_t> epoch_;
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    utils::PeriodicTask cleanup_task_;
+    engine::TaskWithResult<void> listen_task_;
+};
+
+}  // namespace orderservice
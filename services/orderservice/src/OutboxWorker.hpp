@@ -1,35 +1,45 @@
 #pragma once
 
 #include <userver/utest/using_namespace_userver.hpp>
-#include <userver/components/component_base.hpp>
-#include <userver/utils/periodic_task.hpp>
-#include <userver/logging/log.hpp>
-#include <userver/yaml_config/merge_schemas.hpp>
-
 #include <userver/clients/http/client.hpp>
-#include <userver/storages/postgres/cluster.hpp>
+
+#include <outbox/Consumer.hpp>
+
+#include <chrono>
 
 
 namespace orderservice {
 
-class OutboxWorker final : public components::ComponentBase {
+// Обработчик outbox заказов: создает заказ из корзины и отправляет запрос на оплату в bankservice.
+// Разбор, повторы и доставку делает общий outbox::Consumer, просыпаясь по NOTIFY из CreateOrder и CheckoutWorker
+class OutboxHandler final {
 public:
     static constexpr std::string_view kName = "outbox-worker";
+    static constexpr std::string_view kTable = "outbox";
 
-    OutboxWorker(const components::ComponentConfig& config,
-                 const components::ComponentContext& component_context);
+    // Канал, в который CreateOrder отправляет pg_notify вместе со вставкой в outbox
+    static constexpr std::string_view kNotifyChannel = "orderservice_outbox";
 
-    ~OutboxWorker() final;
+    static outbox::DynamicConfigKeys ConfigKeys();
 
-    static yaml_config::Schema GetStaticConfigSchema();
+    OutboxHandler(const components::ComponentConfig& config,
+                  const components::ComponentContext& component_context);
 
-private:
-    void DoWork();
+    // Создает заказ с элементами и read model истории; возвращает запрос на оплату
+    std::optional<formats::json::Value> Process(storages::postgres::Transaction& transaction,
+                                                const outbox::Record& record);
+
+    // Отправляет запрос на оплату в bankservice
+    void Deliver(const outbox::Record& record, const formats::json::Value& message);
 
-    utils::PeriodicTask periodic_task_;
-    userver::storages::postgres::ClusterPtr pg_cluster_;
+    // Продажи в рейтинге учитывает PaymentResult, когда заказ оплачен
+    void OnCommitted(const std::vector<outbox::Record>&) {}
+
+private:
+    const std::chrono::milliseconds delivery_timeout_;
     userver::clients::http::Client& http_client_;
 };
 
-}  // namespace orderservice
+using OutboxWorker = outbox::Consumer<OutboxHandler>;
 
+}  // namespace orderservice
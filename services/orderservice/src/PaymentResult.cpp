@@ -1,8 +1,14 @@
 #include "PaymentResult.hpp"
 
+#include <OrderEvents.hpp>
+
 #include <userver/storages/postgres/component.hpp>
+#include <userver/storages/postgres/io/chrono.hpp>
 #include <userver/formats/json.hpp>
 #include <userver/clients/http/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
 
 namespace orderservice {
 
@@ -12,7 +18,9 @@ PaymentResult::PaymentResult(
 )
     : HttpHandlerBase(config, component_context),
       pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
-      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()) {}
+      http_client_(component_context.FindComponent<userver::components::HttpClient>().GetHttpClient()),
+      sales_ranking_(component_context.FindComponent<SalesRanking>()),
+      internal_token_(config["internal-token"].As<std::string>("")) {}
 
 std::string PaymentResult::HandleRequestThrow(
     const userver::server::http::HttpRequest& request,
@@ -23,67 +31,136 @@ std::string PaymentResult::HandleRequestThrow(
         const auto order_id  = body_json["order_id"].As<int>();
         const auto status    = body_json["status"].As<std::string>();
 
-        // Обновляем статус заказа
-        pg_cluster_->Execute(
+        // Обновляем статус заказа, агрегаты и read model истории заказов в одной транзакции
+        auto transaction = pg_cluster_->Begin(
             userver::storages::postgres::ClusterHostType::kMaster,
-            "UPDATE orderserviceschema.orders SET status = $1 WHERE id = $2",
+            userver::storages::postgres::TransactionOptions{}
+        );
+
+        // Предыдущий статус нужен, чтобы повторная доставка результата не меняла агрегаты второй раз
+        auto order_result = transaction.Execute(
+            "WITH previous AS ("
+            "    SELECT id, created_at, status FROM orderserviceschema.orders WHERE id = $2 FOR UPDATE"
+            ") "
+            "UPDATE orderserviceschema.orders o SET status = $1 "
+            "FROM previous WHERE o.id = previous.id AND o.created_at = previous.created_at "
+            "RETURNING o.user_id, o.created_at, previous.status AS previous_status",
             status,
             order_id
         );
 
-        // Если статус не "PAID", возвращаем товары в корзину
-        if (status != "PAID") {
-            // Получаем user_id и товары из заказа
-            auto order_result = pg_cluster_->Execute(
-                userver::storages::postgres::ClusterHostType::kMaster,
-                "SELECT user_id FROM orderserviceschema.orders WHERE id = $1",
-                order_id
+        if (order_result.Size() == 0) {
+            transaction.Rollback();
+            request.SetResponseStatus(userver::server::http::HttpStatus::kNotFound);
+            return R"({"error":"order not found"})";
+        }
+
+        const auto user_id = order_result[0]["user_id"].As<int>();
+        const auto created_at = order_result[0]["created_at"].As<userver::storages::postgres::TimePointWithoutTz>();
+        const auto previous_status = order_result[0]["previous_status"].As<std::string>();
+
+        // +1 - заказ стал оплаченным, -1 - перестал им быть
+        const int paid_delta = (status == "PAID" ? 1 : 0) - (previous_status == "PAID" ? 1 : 0);
+        // Продажи для рейтинга, со знаком изменения
+        SalesRanking::Sales sales;
+        if (paid_delta != 0) {
+            transaction.Execute(
+                "WITH o AS ("
+                "    SELECT user_id, total_amount FROM orderserviceschema.orders WHERE id = $1 AND created_at = $2"
+                "), user_stats AS ("
+                "    INSERT INTO orderserviceschema.user_order_stats (user_id, paid_orders_count, total_spent) "
+                "    SELECT user_id, $3, $3 * total_amount FROM o "
+                "    ON CONFLICT (user_id) DO UPDATE "
+                "    SET paid_orders_count = user_order_stats.paid_orders_count + EXCLUDED.paid_orders_count, "
+                "        total_spent = user_order_stats.total_spent + EXCLUDED.total_spent, "
+                "        updated_at = now()"
+                ") "
+                "INSERT INTO orderserviceschema.seller_sales_stats (seller_name, orders_count, units_sold, revenue) "
+                "SELECT seller_name, $3, $3 * SUM(quantity), $3 * SUM(quantity * price) "
+                "FROM orderserviceschema.order_items "
+                "WHERE order_id = $1 AND created_at = $2 AND seller_name IS NOT NULL "
+                "GROUP BY seller_name "
+                "ON CONFLICT (seller_name) DO UPDATE "
+                "SET orders_count = seller_sales_stats.orders_count + EXCLUDED.orders_count, "
+                "    units_sold = seller_sales_stats.units_sold + EXCLUDED.units_sold, "
+                "    revenue = seller_sales_stats.revenue + EXCLUDED.revenue, "
+                "    updated_at = now()",
+                order_id,
+                created_at,
+                paid_delta
             );
 
-            if (order_result.Size() == 0) {
-                request.SetResponseStatus(userver::server::http::HttpStatus::kNotFound);
-                return R"({"error":"order not found"})";
+            auto sold = transaction.Execute(
+                "SELECT article, quantity FROM orderserviceschema.order_items "
+                "WHERE order_id = $1 AND created_at = $2",
+                order_id,
+                created_at
+            );
+            for (const auto& row : sold) {
+                sales.emplace_back(row["article"].As<std::string>(), paid_delta * row["quantity"].As<int>());
             }
+        }
 
-            const auto user_id = order_result[0]["user_id"].As<int>();
+        transaction.Execute(
+            "SELECT orderserviceschema.refresh_user_order_history($1)",
+            user_id
+        );
 
-            // Получаем все товары из заказа
+        // Событие для подписчиков /order-events; NOTIFY уходит только при коммите и доставляется
+        // в порядке коммитов, номер событию дает OrderEvents при получении
+        transaction.Execute(
+            "SELECT pg_notify($1, json_build_object("
+            "    'user_id', $2::int, 'order_id', $3::int, 'status', $4::text"
+            ")::text)",
+            std::string{OrderEvents::kNotifyChannel},
+            user_id,
+            order_id,
+            status
+        );
+
+        transaction.Commit();
+
+        if (paid_delta != 0) {
+            sales_ranking_.RecordSales(order_id, paid_delta > 0, sales);
+        }
+
+        // Если статус не "PAID", возвращаем товары в корзину одним запросом.
+        // cartservice применяет возврат один раз на order_id, поэтому при ошибке отвечаем 500:
+        // bankservice повторит доставку результата, а статус и агрегаты повтор не изменит
+        if (status != "PAID") {
             auto items_result = pg_cluster_->Execute(
                 userver::storages::postgres::ClusterHostType::kMaster,
-                "SELECT article, quantity FROM order_items WHERE order_id = $1",
-                order_id
+                "SELECT article, quantity FROM order_items WHERE order_id = $1 AND created_at = $2",
+                order_id, created_at
             );
 
-            // Для каждого товара вызываем ручку корзины
+            userver::formats::json::ValueBuilder items = userver::formats::json::MakeArray();
             for (const auto& row : items_result) {
-                const auto article = row["article"].As<std::string>();
-                const auto quantity = row["quantity"].As<int>();
-
-                try {
-                    // Вызываем ручку cartservice для добавления товара в корзину
-                    auto cart_response = http_client_.CreateRequest()
-                        .post()
-                        .url("http://cartservice:8080/change-cart-product-count-by-user-id")
-                        .headers({{"Content-Type", "application/json"}})
-                        .data(userver::formats::json::ToString(
-                            userver::formats::json::MakeObject(
-                                "userId", user_id,
-                                "article", article,
-                                "productQuantity", quantity
-                            )
-                        ))
-                        .timeout(std::chrono::seconds(2))
-                        .perform();
-
-                    if (cart_response->status_code() != 204) {
-                        LOG_ERROR() << "Failed to add item to cart: " << cart_response->body()
-                                  << ", status: " << cart_response->status_code();
-                    }
-
-                } catch (const std::exception& ex) {
-                    LOG_ERROR() << "Error while calling cartservice for article " << article
-                              << ": " << ex.what();
-                }
+                userver::formats::json::ValueBuilder item;
+                item["article"] = row["article"].As<std::string>();
+                item["quantity"] = row["quantity"].As<int>();
+                items.PushBack(std::move(item));
+            }
+
+            userver::formats::json::ValueBuilder restock_request;
+            restock_request["userId"] = user_id;
+            restock_request["orderId"] = order_id;
+            restock_request["items"] = items;
+
+            auto cart_response = http_client_.CreateRequest()
+                .post()
+                .url("http://cartservice:8080/restock-order")
+                .headers({{"Content-Type", "application/json"},
+                          {std::string{internal_auth::kHeader}, internal_token_}})
+                .data(userver::formats::json::ToString(restock_request.ExtractValue()))
+                .timeout(std::chrono::seconds(2))
+                .perform();
+
+            if (cart_response->status_code() != 204) {
+                LOG_ERROR() << "Failed to restock order " << order_id << ": " << cart_response->body()
+                            << ", status: " << cart_response->status_code();
+                request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+                return R"({"error":"failed to restock cart"})";
             }
         }
 
@@ -97,5 +174,18 @@ std::string PaymentResult::HandleRequestThrow(
     }
 }
 
+userver::yaml_config::Schema PaymentResult::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Payment result from bankservice
+additionalProperties: false
+properties:
+    internal-token:
+        type: string
+        description: token sent to cartservice restock-order in the X-Internal-Token header
+        defaultDescription: ''
+)");
+}
+
 }  // namespace orderservice
 
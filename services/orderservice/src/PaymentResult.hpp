@@ -4,6 +4,11 @@
 #include <userver/server/handlers/http_handler_base.hpp>
 #include <userver/storages/postgres/cluster.hpp>
 #include <userver/clients/http/client.hpp>
+#include <userver/yaml_config/schema.hpp>
+
+#include <string>
+
+#include <SalesRanking.hpp>
 
 namespace orderservice {
 
@@ -18,9 +23,14 @@ public:
         const userver::server::http::HttpRequest&,
         userver::server::request::RequestContext&) const override;
 
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
 private:
     userver::storages::postgres::ClusterPtr pg_cluster_;
     userver::clients::http::Client& http_client_;
+    SalesRanking& sales_ranking_;
+    // restock-order в cartservice служебная, токен передается в заголовке X-Internal-Token
+    const std::string internal_token_;
 };
 
 }  // namespace orderservice
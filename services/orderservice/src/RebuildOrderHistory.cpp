@@ -0,0 +1,149 @@
+#include <RebuildOrderHistory.hpp>
+
+#include <userver/engine/async.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/engine/task/current_task.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace orderservice {
+
+namespace {
+
+constexpr std::int64_t kUsersBatchSize = 100;
+
+}  // namespace
+
+RebuildOrderHistory::RebuildOrderHistory(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      internal_token_(config["internal-token"].As<std::string>("")),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()) {}
+
+RebuildOrderHistory::~RebuildOrderHistory() {
+    if (rebuild_task_.IsValid()) {
+        rebuild_task_.SyncCancel();
+    }
+}
+
+std::string RebuildOrderHistory::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&
+) const {
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        return R"({"error": "Forbidden"})";
+    }
+
+    try {
+        // ?user_id=N - пересобрать одного пользователя, иначе всех в фоне
+        if (request.HasArg("user_id")) {
+            pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "SELECT orderserviceschema.refresh_user_order_history($1)",
+                std::stoi(request.GetArg("user_id"))
+            );
+
+            request.SetResponseStatus(userver::server::http::HttpStatus::kOk);
+            return R"({"users": 1})";
+        }
+
+        std::lock_guard lock(rebuild_mutex_);
+
+        if (rebuild_task_.IsValid() && !rebuild_task_.IsFinished()) {
+            request.SetResponseStatus(userver::server::http::HttpStatus::kConflict);
+            return userver::formats::json::ToString(userver::formats::json::MakeObject(
+                "status", "running", "users", rebuilt_users_.load()
+            ));
+        }
+
+        // Задача не привязана к запросу: ни дедлайн запроса, ни отключение клиента ее не отменяют.
+        // Отменяется она только при остановке сервиса
+        rebuilt_users_ = 0;
+        rebuild_task_ = userver::engine::CriticalAsyncNoSpan(
+            userver::engine::current_task::GetTaskProcessor(),
+            [this] { RebuildAll(); }
+        );
+
+        request.SetResponseStatus(userver::server::http::HttpStatus::kAccepted);
+        return R"({"status": "started"})";
+
+    } catch (const std::logic_error& ex) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kBadRequest);
+        return R"({"field": "user_id", "error": "Invalid user_id"})";
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while rebuilding order history: " << ex.what();
+        request.SetResponseStatus(userver::server::http::HttpStatus::kInternalServerError);
+        return R"({"error": "Internal server error"})";
+    }
+}
+
+void RebuildOrderHistory::RebuildAll() const {
+    try {
+        int last_user_id = 0;
+
+        while (!userver::engine::current_task::ShouldCancel()) {
+            // Пачкой только выбираем пользователей, без блокировок
+            auto users = pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "SELECT DISTINCT user_id FROM orderserviceschema.orders "
+                "WHERE user_id > $1 ORDER BY user_id LIMIT $2",
+                last_user_id,
+                kUsersBatchSize
+            ).AsContainer<std::vector<int>>();
+
+            if (users.empty()) {
+                LOG_INFO() << "Rebuilt order history for " << rebuilt_users_.load() << " users";
+                return;
+            }
+
+            // Каждый пользователь - отдельная транзакция с одной advisory-блокировкой.
+            // Несколько блокировок в одной транзакции взялись бы в порядке user_id,
+            // а OutboxWorker и PaymentResult берут их в своем порядке - это взаимоблокировка
+            for (const auto user_id : users) {
+                if (userver::engine::current_task::ShouldCancel()) {
+                    break;
+                }
+
+                pg_cluster_->Execute(
+                    userver::storages::postgres::ClusterHostType::kMaster,
+                    "SELECT orderserviceschema.refresh_user_order_history($1)",
+                    user_id
+                );
+
+                ++rebuilt_users_;
+                last_user_id = user_id;
+            }
+        }
+
+        LOG_WARNING() << "Order history rebuild cancelled after " << rebuilt_users_.load() << " users";
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while rebuilding order history after " << rebuilt_users_.load()
+                    << " users: " << ex.what();
+    }
+}
+
+userver::yaml_config::Schema RebuildOrderHistory::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Rebuilds the user order history read model
+additionalProperties: false
+properties:
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace orderservice
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace orderservice {
+
+// Пересборка read model истории заказов (backfill): make rebuild-order-history.
+//   ?user_id=N - пересобрать одного пользователя сразу, в ответе {"users": 1}
+//   без user_id - пересборка всех пользователей в фоновой задаче: 202 при запуске,
+//                 409 с числом уже пересобранных пользователей, пока она идет
+// Только внутри сети: nginx ручку не проксирует, без X-Internal-Token с internal-token - 403
+class RebuildOrderHistory final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-rebuild-order-history";
+
+    RebuildOrderHistory(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    ~RebuildOrderHistory() override;
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void RebuildAll() const;
+
+    const std::string internal_token_;
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    mutable userver::engine::Mutex rebuild_mutex_;
+    mutable userver::engine::TaskWithResult<void> rebuild_task_;
+    mutable std::atomic<std::int64_t> rebuilt_users_{0};
+};
+
+}  // namespace orderservice
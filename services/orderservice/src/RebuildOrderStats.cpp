@@ -0,0 +1,175 @@
+#include <RebuildOrderStats.hpp>
+
+#include <userver/engine/async.hpp>
+#include <userver/engine/task/cancel.hpp>
+#include <userver/engine/task/current_task.hpp>
+#include <userver/formats/json.hpp>
+#include <userver/server/http/http_status.hpp>
+#include <userver/storages/postgres/component.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <internal_auth/Token.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace orderservice {
+
+namespace {
+
+constexpr std::int64_t kKeysBatchSize = 100;
+
+}  // namespace
+
+RebuildOrderStats::RebuildOrderStats(
+    const userver::components::ComponentConfig& config,
+    const userver::components::ComponentContext& component_context
+)
+    : HttpHandlerBase(config, component_context),
+      internal_token_(config["internal-token"].As<std::string>("")),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()) {}
+
+RebuildOrderStats::~RebuildOrderStats() {
+    if (rebuild_task_.IsValid()) {
+        rebuild_task_.SyncCancel();
+    }
+}
+
+std::string RebuildOrderStats::HandleRequestThrow(
+    const userver::server::http::HttpRequest& request,
+    userver::server::request::RequestContext&
+) const {
+    if (!internal_auth::IsInternalRequest(request, internal_token_)) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kForbidden);
+        return R"({"error": "Forbidden"})";
+    }
+
+    std::lock_guard lock(rebuild_mutex_);
+
+    if (rebuild_task_.IsValid() && !rebuild_task_.IsFinished()) {
+        request.SetResponseStatus(userver::server::http::HttpStatus::kConflict);
+        return userver::formats::json::ToString(userver::formats::json::MakeObject(
+            "status", "running", "users", rebuilt_users_.load(), "sellers", rebuilt_sellers_.load()
+        ));
+    }
+
+    // Как и пересборка истории заказов, задача не привязана к запросу и отменяется только при остановке сервиса
+    rebuilt_users_ = 0;
+    rebuilt_sellers_ = 0;
+    rebuild_task_ = userver::engine::CriticalAsyncNoSpan(
+        userver::engine::current_task::GetTaskProcessor(),
+        [this] { RebuildAll(); }
+    );
+
+    request.SetResponseStatus(userver::server::http::HttpStatus::kAccepted);
+    return R"({"status": "started"})";
+}
+
+void RebuildOrderStats::RebuildAll() const {
+    try {
+        RebuildUsers();
+        RebuildSellers();
+
+        if (userver::engine::current_task::ShouldCancel()) {
+            LOG_WARNING() << "Order stats rebuild cancelled after " << rebuilt_users_.load() << " users and "
+                          << rebuilt_sellers_.load() << " sellers";
+            return;
+        }
+
+        LOG_INFO() << "Rebuilt order stats for " << rebuilt_users_.load() << " users and "
+                   << rebuilt_sellers_.load() << " sellers";
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Error while rebuilding order stats after " << rebuilt_users_.load() << " users and "
+                    << rebuilt_sellers_.load() << " sellers: " << ex.what();
+    }
+}
+
+void RebuildOrderStats::RebuildUsers() const {
+    int last_user_id = 0;
+
+    while (!userver::engine::current_task::ShouldCancel()) {
+        // Строки агрегата без заказов тоже пересчитываются - в нули
+        auto users = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT user_id FROM ("
+            "    SELECT user_id FROM orderserviceschema.orders "
+            "    UNION SELECT user_id FROM orderserviceschema.user_order_stats"
+            ") users "
+            "WHERE user_id > $1 ORDER BY user_id LIMIT $2",
+            last_user_id,
+            kKeysBatchSize
+        ).AsContainer<std::vector<int>>();
+
+        if (users.empty()) {
+            return;
+        }
+
+        // Каждый пользователь - отдельная транзакция, блокирующая одну строку user_order_stats
+        for (const auto user_id : users) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                return;
+            }
+
+            pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "SELECT orderserviceschema.rebuild_user_order_stats($1)",
+                user_id
+            );
+
+            ++rebuilt_users_;
+            last_user_id = user_id;
+        }
+    }
+}
+
+void RebuildOrderStats::RebuildSellers() const {
+    std::string last_seller_name;
+
+    while (!userver::engine::current_task::ShouldCancel()) {
+        auto sellers = pg_cluster_->Execute(
+            userver::storages::postgres::ClusterHostType::kMaster,
+            "SELECT seller_name FROM ("
+            "    SELECT seller_name FROM orderserviceschema.order_items WHERE seller_name IS NOT NULL "
+            "    UNION SELECT seller_name FROM orderserviceschema.seller_sales_stats"
+            ") sellers "
+            "WHERE seller_name > $1 ORDER BY seller_name LIMIT $2",
+            last_seller_name,
+            kKeysBatchSize
+        ).AsContainer<std::vector<std::string>>();
+
+        if (sellers.empty()) {
+            return;
+        }
+
+        for (const auto& seller_name : sellers) {
+            if (userver::engine::current_task::ShouldCancel()) {
+                return;
+            }
+
+            pg_cluster_->Execute(
+                userver::storages::postgres::ClusterHostType::kMaster,
+                "SELECT orderserviceschema.rebuild_seller_sales_stats($1)",
+                seller_name
+            );
+
+            ++rebuilt_sellers_;
+            last_seller_name = seller_name;
+        }
+    }
+}
+
+userver::yaml_config::Schema RebuildOrderStats::GetStaticConfigSchema() {
+    return userver::yaml_config::MergeSchemas<userver::server::handlers::HttpHandlerBase>(R"(
+type: object
+description: Rebuilds user and seller order stats from scratch
+additionalProperties: false
+properties:
+    internal-token:
+        type: string
+        description: token expected in the X-Internal-Token header; empty rejects every request
+        defaultDescription: ''
+)");
+}
+
+}  // namespace orderservice
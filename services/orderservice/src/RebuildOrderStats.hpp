@@ -0,0 +1,47 @@
+#pragma once
+
+#include <userver/components/component.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/engine/task/task_with_result.hpp>
+#include <userver/server/handlers/http_handler_base.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace orderservice {
+
+// Пересчет агрегатов user_order_stats и seller_sales_stats с нуля: make rebuild-order-stats.
+// Идет в фоновой задаче по одному пользователю или продавцу на транзакцию: 202 при запуске,
+// 409 с числом уже пересчитанных пользователей и продавцов, пока она идет
+// Только внутри сети: nginx ручку не проксирует, без X-Internal-Token с internal-token - 403
+class RebuildOrderStats final : public userver::server::handlers::HttpHandlerBase {
+public:
+    static constexpr std::string_view kName = "handler-rebuild-order-stats";
+
+    RebuildOrderStats(const userver::components::ComponentConfig&, const userver::components::ComponentContext&);
+
+    ~RebuildOrderStats() override;
+
+    std::string HandleRequestThrow(const userver::server::http::HttpRequest&, userver::server::request::RequestContext&)
+        const override;
+
+    static userver::yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    void RebuildAll() const;
+    void RebuildUsers() const;
+    void RebuildSellers() const;
+
+    const std::string internal_token_;
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+
+    mutable userver::engine::Mutex rebuild_mutex_;
+    mutable userver::engine::TaskWithResult<void> rebuild_task_;
+    mutable std::atomic<std::int64_t> rebuilt_users_{0};
+    mutable std::atomic<std::int64_t> rebuilt_sellers_{0};
+};
+
+}  // namespace orderservice
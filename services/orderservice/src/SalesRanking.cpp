@@ -0,0 +1,259 @@
+#include "SalesRanking.hpp"
+
+#include <userver/components/component.hpp>
+#include <userver/logging/log.hpp>
+#include <userver/storages/postgres/component.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <unordered_set>
+
+namespace orderservice {
+
+namespace {
+
+// Пересчет агрегирует все order_items, таймауты по умолчанию для него малы
+const userver::storages::postgres::CommandControl kResyncCommandControl{
+    std::chrono::minutes{2}, std::chrono::minutes{2}
+};
+
+}  // namespace
+
+void SalesRanking::RankedCounters::Add(const std::string& article, std::int64_t units) {
+    if (units == 0) {
+        return;
+    }
+
+    auto& count = counters[article];
+    if (count != 0) {
+        ranking.erase({count, article});
+    }
+
+    count += units;
+    if (count > 0) {
+        ranking.emplace(count, article);
+    } else {
+        counters.erase(article);
+    }
+}
+
+void SalesRanking::RankedCounters::Reset(Counters&& new_counters) {
+    counters = std::move(new_counters);
+    ranking.clear();
+    for (const auto& [article, count] : counters) {
+        ranking.emplace(count, article);
+    }
+}
+
+SalesRanking::SalesRanking(const components::ComponentConfig& config,
+                           const components::ComponentContext& component_context)
+    : components::ComponentBase(config, component_context),
+      pg_cluster_(component_context.FindComponent<userver::components::Postgres>("postgres-db-1").GetCluster()),
+      bucket_duration_(config["bucket-duration"].As<std::chrono::seconds>(std::chrono::hours{1})),
+      window_buckets_(std::max<std::size_t>(config["window-buckets"].As<std::size_t>(24), 1))
+{
+    current_bucket_ = BucketIndex(std::chrono::system_clock::now());
+    buckets_.resize(window_buckets_);
+
+    Resync();
+
+    utils::PeriodicTask::Settings settings{
+        config["resync-interval"].As<std::chrono::milliseconds>(std::chrono::minutes{5})
+    };
+    resync_task_.Start("sales-ranking-resync", settings, [this] { Resync(); });
+}
+
+SalesRanking::~SalesRanking() {
+    resync_task_.Stop();
+}
+
+void SalesRanking::RecordSales(int order_id, bool paid, const Sales& sales) {
+    std::lock_guard lock(mutex_);
+    RotateBuckets(BucketIndex(std::chrono::system_clock::now()));
+    ApplySales(sales);
+
+    if (resync_journal_) {
+        auto& entry = (*resync_journal_)[order_id];
+        entry.paid = paid;
+        entry.sales.insert(entry.sales.end(), sales.begin(), sales.end());
+    }
+}
+
+void SalesRanking::ApplySales(const Sales& sales) {
+    for (const auto& [article, quantity] : sales) {
+        all_time_.Add(article, quantity);
+        recent_.Add(article, quantity);
+        buckets_.back()[article] += quantity;
+    }
+}
+
+std::vector<SalesRanking::Entry> SalesRanking::GetTop(Window window, std::size_t limit) {
+    std::lock_guard lock(mutex_);
+    RotateBuckets(BucketIndex(std::chrono::system_clock::now()));
+
+    const auto& ranking = (window == Window::kAllTime ? all_time_ : recent_).ranking;
+
+    std::vector<Entry> result;
+    result.reserve(std::min(limit, ranking.size()));
+    for (auto it = ranking.begin(); it != ranking.end() && result.size() < limit; ++it) {
+        result.push_back({it->second, it->first});
+    }
+    return result;
+}
+
+std::int64_t SalesRanking::BucketIndex(std::chrono::system_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count() /
+           bucket_duration_.count();
+}
+
+void SalesRanking::RotateBuckets(std::int64_t current_bucket) {
+    if (current_bucket <= current_bucket_) {
+        return;
+    }
+
+    const auto steps = static_cast<std::size_t>(current_bucket - current_bucket_);
+    current_bucket_ = current_bucket;
+
+    if (steps >= window_buckets_) {
+        buckets_.assign(window_buckets_, {});
+        recent_.Reset({});
+        return;
+    }
+
+    // Выкидываем из окна устаревшие интервалы
+    for (std::size_t i = 0; i < steps; ++i) {
+        for (const auto& [article, units] : buckets_.front()) {
+            recent_.Add(article, -units);
+        }
+        buckets_.pop_front();
+        buckets_.emplace_back();
+    }
+}
+
+void SalesRanking::Resync() {
+    {
+        std::lock_guard lock(mutex_);
+        resync_journal_.emplace();
+    }
+
+    try {
+        const auto current_bucket = BucketIndex(std::chrono::system_clock::now());
+        const auto first_bucket = current_bucket - static_cast<std::int64_t>(window_buckets_) + 1;
+
+        // Оба агрегата и проверка заказов из журнала читают один снимок
+        auto transaction = pg_cluster_->Begin(
+            "sales_ranking_resync",
+            userver::storages::postgres::ClusterHostType::kSlave,
+            userver::storages::postgres::TransactionOptions{
+                userver::storages::postgres::IsolationLevel::kRepeatableRead,
+                userver::storages::postgres::TransactionOptions::kReadOnly
+            },
+            kResyncCommandControl
+        );
+
+        auto all_time_result = transaction.Execute(
+            "SELECT oi.article, SUM(oi.quantity)::bigint AS units "
+            "FROM orderserviceschema.order_items oi "
+            "JOIN orderserviceschema.orders o ON o.id = oi.order_id AND o.created_at = oi.created_at "
+            "WHERE o.status = 'PAID' "
+            "GROUP BY oi.article"
+        );
+
+        auto recent_result = transaction.Execute(
+            "SELECT oi.article, FLOOR(EXTRACT(EPOCH FROM o.created_at) / $1)::bigint AS bucket, "
+            "SUM(oi.quantity)::bigint AS units "
+            "FROM orderserviceschema.order_items oi "
+            "JOIN orderserviceschema.orders o ON o.id = oi.order_id AND o.created_at = oi.created_at "
+            "WHERE oi.created_at >= to_timestamp($2) AT TIME ZONE 'UTC' AND o.status = 'PAID' "
+            "GROUP BY 1, 2",
+            static_cast<std::int64_t>(bucket_duration_.count()),
+            static_cast<double>(first_bucket * bucket_duration_.count())
+        );
+
+        // Заказы, оплата которых изменилась за время пересчета: снимок мог их уже учесть
+        std::vector<int> journaled_orders;
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto& [order_id, entry] : *resync_journal_) {
+                journaled_orders.push_back(order_id);
+            }
+        }
+
+        auto paid_result = transaction.Execute(
+            "SELECT id FROM orderserviceschema.orders WHERE id = ANY($1) AND status = 'PAID'",
+            journaled_orders
+        );
+
+        transaction.Commit();
+
+        const std::unordered_set<int> checked_orders(journaled_orders.begin(), journaled_orders.end());
+        std::unordered_set<int> paid_in_snapshot;
+        for (const auto& row : paid_result) {
+            paid_in_snapshot.insert(row["id"].As<int>());
+        }
+
+        Counters all_time;
+        for (const auto& row : all_time_result) {
+            all_time[row["article"].As<std::string>()] = row["units"].As<std::int64_t>();
+        }
+
+        std::deque<Counters> buckets(window_buckets_);
+        Counters recent;
+        for (const auto& row : recent_result) {
+            const auto bucket = row["bucket"].As<std::int64_t>();
+            if (bucket < first_bucket || bucket > current_bucket) {
+                continue;
+            }
+
+            const auto article = row["article"].As<std::string>();
+            const auto units = row["units"].As<std::int64_t>();
+            buckets[bucket - first_bucket][article] += units;
+            recent[article] += units;
+        }
+
+        std::lock_guard lock(mutex_);
+        all_time_.Reset(std::move(all_time));
+        recent_.Reset(std::move(recent));
+        buckets_ = std::move(buckets);
+        current_bucket_ = current_bucket;
+        RotateBuckets(BucketIndex(std::chrono::system_clock::now()));
+
+        // Заказы, пришедшие после проверки, снимок не видел; проверенные - если состояние в снимке другое
+        for (const auto& [order_id, entry] : *resync_journal_) {
+            if (checked_orders.count(order_id) > 0 && (paid_in_snapshot.count(order_id) > 0) == entry.paid) {
+                continue;
+            }
+            ApplySales(entry.sales);
+        }
+        resync_journal_.reset();
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR() << "Failed to resync sales ranking: " << ex.what();
+        std::lock_guard lock(mutex_);
+        resync_journal_.reset();
+    }
+}
+
+yaml_config::Schema SalesRanking::GetStaticConfigSchema() {
+    return yaml_config::MergeSchemas<components::ComponentBase>(R"(
+type: object
+description: In-memory best-seller rankings
+additionalProperties: false
+properties:
+    bucket-duration:
+        type: string
+        description: duration of one sliding window interval
+        defaultDescription: 1h
+    window-buckets:
+        type: integer
+        description: number of intervals in the sliding window
+        defaultDescription: 24
+    resync-interval:
+        type: string
+        description: how often counters are recomputed from database
+        defaultDescription: 5m
+)");
+}
+
+}  // namespace orderservice
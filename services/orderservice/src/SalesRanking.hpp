@@ -0,0 +1,94 @@
+#pragma once
+
+#include <userver/utest/using_namespace_userver.hpp>
+#include <userver/components/component_base.hpp>
+#include <userver/engine/mutex.hpp>
+#include <userver/utils/periodic_task.hpp>
+#include <userver/yaml_config/merge_schemas.hpp>
+
+#include <userver/storages/postgres/cluster.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace orderservice {
+
+// Счетчики продаж оплаченных заказов по артикулам: за все время и за скользящее окно из
+// window-buckets интервалов по bucket-duration. PaymentResult добавляет продажи, когда заказ
+// становится оплаченным, и вычитает, если перестает им быть. Рейтинги хранятся уже
+// отсортированными, поэтому топ-N отдается за O(N).
+// Раз в resync-interval счетчики пересчитываются из БД, чтобы учесть заказы других реплик.
+// Изменения, пришедшие во время пересчета, применяются поверх него, если снимок БД их не видел.
+class SalesRanking final : public components::ComponentBase {
+public:
+    static constexpr std::string_view kName = "sales-ranking";
+
+    enum class Window { kAllTime, kRecent };
+
+    struct Entry {
+        std::string article;
+        std::int64_t units{0};
+    };
+
+    using Sales = std::vector<std::pair<std::string, int>>;
+
+    SalesRanking(const components::ComponentConfig& config,
+                 const components::ComponentContext& component_context);
+
+    ~SalesRanking() final;
+
+    // paid - оплачен ли заказ после изменения; в sales количества уже со знаком изменения
+    void RecordSales(int order_id, bool paid, const Sales& sales);
+
+    std::vector<Entry> GetTop(Window window, std::size_t limit);
+
+    static yaml_config::Schema GetStaticConfigSchema();
+
+private:
+    using Counters = std::unordered_map<std::string, std::int64_t>;
+    using Ranking = std::set<std::pair<std::int64_t, std::string>, std::greater<>>;
+
+    // Счетчики с отсортированным представлением, которое обновляется вместе с ними
+    struct RankedCounters {
+        Counters counters;
+        Ranking ranking;
+
+        void Add(const std::string& article, std::int64_t units);
+        void Reset(Counters&& new_counters);
+    };
+
+    // Изменение оплаты заказа, пришедшее во время Resync
+    struct JournalEntry {
+        bool paid{false};
+        Sales sales;
+    };
+
+    std::int64_t BucketIndex(std::chrono::system_clock::time_point time) const;
+    void ApplySales(const Sales& sales);
+    void RotateBuckets(std::int64_t current_bucket);
+    void Resync();
+
+    userver::storages::postgres::ClusterPtr pg_cluster_;
+    const std::chrono::seconds bucket_duration_;
+    const std::size_t window_buckets_;
+
+    engine::Mutex mutex_;
+    RankedCounters all_time_;
+    RankedCounters recent_;
+    std::deque<Counters> buckets_;  // последний элемент - текущий интервал
+    std::int64_t current_bucket_{0};
+    // Есть, пока идет Resync
+    std::optional<std::unordered_map<int, JournalEntry>> resync_journal_;
+
+    utils::PeriodicTask resync_task_;
+};
+
+}  // namespace orderservice
@@ -10,10 +10,27 @@
 
 #include <userver/utils/daemon_run.hpp>
 
+#include <outbox/Archiver.hpp>
+#include <partitioning/Maintenance.hpp>
+
 #include <CreateOrder.hpp>
 #include <PaymentResult.hpp>
 #include <OutboxWorker.hpp>
 #include <FetchOrdersBulk.hpp>
+#include <SalesRanking.hpp>
+#include <BestSellers.hpp>
+#include <RebuildOrderHistory.hpp>
+#include <OrderEvents.hpp>
+#include <FetchOrderEvents.hpp>
+#include <Checkout.hpp>
+#include <CheckoutWorker.hpp>
+#include <CheckoutStatus.hpp>
+#include <AdmissionControl.hpp>
+#include <AdmissionStatus.hpp>
+#include <ExportOrders.hpp>
+#include <FetchUserStats.hpp>
+#include <FetchSellerStats.hpp>
+#include <RebuildOrderStats.hpp>
 
 int main(int argc, char* argv[]) {
     auto component_list = userver::components::MinimalServerComponentList()
@@ -24,7 +41,24 @@ int main(int argc, char* argv[]) {
                               .Append<orderservice::CreateOrder>()
                               .Append<orderservice::PaymentResult>()
                               .Append<orderservice::OutboxWorker>()
+                              .Append<outbox::Archiver>()
+                              .Append<partitioning::Maintenance>()
                               .Append<orderservice::FetchOrdersBulk>()
+                              .Append<orderservice::SalesRanking>()
+                              .Append<orderservice::BestSellers>()
+                              .Append<orderservice::RebuildOrderHistory>()
+                              .Append<orderservice::OrderEvents>()
+                              .Append<orderservice::FetchOrderEvents>()
+                              .Append<orderservice::Checkout>()
+                              .Append<orderservice::CheckoutWorker>()
+                              .Append<orderservice::CheckoutStatus>()
+                              .Append<outbox::Archiver>("checkout-outbox-archiver")
+                              .Append<orderservice::AdmissionControl>()
+                              .Append<orderservice::AdmissionStatus>()
+                              .Append<orderservice::ExportOrders>()
+                              .Append<orderservice::FetchUserStats>()
+                              .Append<orderservice::FetchSellerStats>()
+                              .Append<orderservice::RebuildOrderStats>()
                               .Append<userver::components::Postgres>("postgres-db-1")
         ;
 